@@ -0,0 +1,175 @@
+/*
+ * binaryPacking.cpp
+ * Copyright (c) 2009 Daisuke Okanohara All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cassert>
+#include "binaryPacking.hpp"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+namespace SE{
+
+namespace {
+
+const size_t HEADER = 2;
+
+uint32_t bitWidth(uint32_t x){
+  uint32_t w = 0;
+  while (x){
+    x >>= 1;
+    w++;
+  }
+  return w;
+}
+
+/// Pack 128 values of W bits into 4*W words
+template<int W> void pack(const uint32_t* in, uint32_t* out){
+  for (int lane = 0; lane < 4; ++lane){
+    uint32_t acc = 0;
+    int shift = 0;
+    uint32_t* o = out + lane;
+    for (int j = 0; j < 32; ++j){
+      const uint32_t x = in[4 * j + lane];
+      acc |= x << shift;
+      shift += W;
+      if (shift >= 32){
+	*o = acc;
+	o += 4;
+	shift -= 32;
+	acc = (shift > 0) ? x >> (W - shift) : 0;
+      }
+    }
+  }
+}
+
+#ifdef __SSE2__
+
+/// Unpack 128 values of W bits and restore positions from gaps
+template<int W> void unpack(const uint32_t* in, uint32_t first, uint32_t* out){
+  const __m128i* pin = reinterpret_cast<const __m128i*>(in);
+  const __m128i mask = _mm_set1_epi32(static_cast<int>((W == 32) ? 0xFFFFFFFFU : (1U << (W & 31)) - 1));
+  __m128i prev = _mm_set1_epi32(first);
+  __m128i w = (W > 0) ? _mm_loadu_si128(pin) : _mm_setzero_si128();
+  int shift = 0;
+  for (int j = 0; j < 32; ++j){
+    __m128i x = _mm_srl_epi32(w, _mm_cvtsi32_si128(shift));
+    shift += W;
+    if (shift >= 32){
+      shift -= 32;
+      if (j < 31 || shift > 0){
+	w = _mm_loadu_si128(++pin);
+      }
+      if (shift > 0){
+	x = _mm_or_si128(x, _mm_sll_epi32(w, _mm_cvtsi32_si128(W - shift)));
+      }
+    }
+    if (W < 32){
+      x = _mm_and_si128(x, mask);
+    }
+
+    // Prefix sum of 4 gaps
+    x = _mm_add_epi32(x, _mm_slli_si128(x, 4));
+    x = _mm_add_epi32(x, _mm_slli_si128(x, 8));
+    x = _mm_add_epi32(x, prev);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4 * j), x);
+    prev = _mm_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 3, 3));
+  }
+}
+
+#else
+
+template<int W> void unpack(const uint32_t* in, uint32_t first, uint32_t* out){
+  const uint32_t mask = (W == 32) ? 0xFFFFFFFFU : (1U << (W & 31)) - 1;
+  for (int lane = 0; lane < 4; ++lane){
+    const uint32_t* p = in + lane;
+    int shift = 0;
+    for (int j = 0; j < 32; ++j){
+      uint32_t x = *p >> shift;
+      shift += W;
+      if (shift >= 32){
+	shift -= 32;
+	p += 4;
+	if (shift > 0){
+	  x |= *p << (W - shift);
+	}
+      }
+      out[4 * j + lane] = x & mask;
+    }
+  }
+  uint32_t prev = first;
+  for (size_t i = 0; i < BinaryPacking::BLOCKSIZE; ++i){
+    out[i] += prev;
+    prev = out[i];
+  }
+}
+
+#endif // __SSE2__
+
+typedef void (*PackFunc)(const uint32_t*, uint32_t*);
+typedef void (*UnpackFunc)(const uint32_t*, uint32_t, uint32_t*);
+
+#define MINISE_BP_FUNCS(f) \
+  { f<0>,  f<1>,  f<2>,  f<3>,  f<4>,  f<5>,  f<6>,  f<7>,  f<8>, \
+    f<9>,  f<10>, f<11>, f<12>, f<13>, f<14>, f<15>, f<16>, \
+    f<17>, f<18>, f<19>, f<20>, f<21>, f<22>, f<23>, f<24>, \
+    f<25>, f<26>, f<27>, f<28>, f<29>, f<30>, f<31>, f<32> }
+
+const PackFunc packFuncs[33] = MINISE_BP_FUNCS(pack);
+const UnpackFunc unpackFuncs[33] = MINISE_BP_FUNCS(unpack);
+
+#undef MINISE_BP_FUNCS
+
+}
+
+void BinaryPacking::encode(const vector<uint32_t>& v, vector<uint8_t>& out){
+  assert(v.size() == BLOCKSIZE);
+  uint32_t gaps[BLOCKSIZE];
+  uint32_t maxGap = 0;
+  gaps[0] = 0;
+  for (size_t i = 1; i < BLOCKSIZE; ++i){
+    gaps[i] = v[i] - v[i-1];
+    maxGap |= gaps[i];
+  }
+  const uint32_t w = bitWidth(maxGap);
+
+  vector<uint32_t> B(HEADER + 4 * w, 0);
+  B[0] = v[0];
+  B[1] = w;
+  packFuncs[w](gaps, &B[0] + HEADER);
+  const uint8_t* p = reinterpret_cast<const uint8_t*>(&B[0]);
+  out.insert(out.end(), p, p + B.size() * sizeof(B[0]));
+}
+
+void BinaryPacking::decode(const uint8_t* p, const size_t size, uint32_t* v, const size_t n){
+  assert(n == BLOCKSIZE);
+  const uint32_t* B = reinterpret_cast<const uint32_t*>(p);
+  unpackFuncs[B[1]](B + HEADER, B[0], v);
+}
+
+}
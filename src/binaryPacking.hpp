@@ -1,5 +1,5 @@
 /*
- * compresedBlock.cpp
+ * binaryPacking.hpp
  * Copyright (c) 2009 Daisuke Okanohara All Rights Reserved.
  *
  * Permission is hereby granted, free of charge, to any person
@@ -24,17 +24,38 @@
  * OTHER DEALINGS IN THE SOFTWARE.
  */
 
-#include "compressedBlock.hpp"
+#ifndef BINARY_PACKING_HPP__
+#define BINARY_PACKING_HPP__
 
-using namespace std;
+#include <vector>
+#include <cstddef>
+#include <stdint.h>
 
 namespace SE{
 
-CompressedBlock::CompressedBlock() {
-}
+/**
+ * SIMD Binary Packing (BP128)
+ * Gaps of 128 positions are packed with a single bit width.
+ * The i-th gap is stored in the lane i%4 of 128-bit words,
+ * so that 4 gaps are unpacked at once, and decoded by an in-register prefix sum.
+ */
+class BinaryPacking {
+public:
+  enum {
+    BLOCKSIZE = 128 ///< The number of positions in a block
+  };
 
-CompressedBlock::~CompressedBlock(){
-}
+  /**
+   * Append the code of v to out (for blocks in an arena, aligned to 4 bytes)
+   */
+  static void encode(const std::vector<uint32_t>& v, std::vector<uint8_t>& out);
+
+  /**
+   * Decode n positions from the code p of size bytes (aligned to 4 bytes, n == BLOCKSIZE)
+   */
+  static void decode(const uint8_t* p, const size_t size, uint32_t* v, const size_t n);
+};
 
 }
 
+#endif // BINARY_PACKING_HPP__
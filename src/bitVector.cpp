@@ -0,0 +1,168 @@
+/*
+ * bitVector.cpp
+ * Copyright (c) 2009 Daisuke Okanohara All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include "bitVector.hpp"
+
+using namespace std;
+
+namespace SE{
+
+BitVector::BitVector() : n(0) {
+}
+
+BitVector::~BitVector(){
+}
+
+void BitVector::push_back(const bool bit){
+  if (n % 64 == 0){
+    bits.push_back(0);
+  }
+  if (bit){
+    bits.writable()[bits.size() - 1] |= 1ULL << (n % 64);
+  }
+  ++n;
+}
+
+void BitVector::build(){
+  const size_t blockN = bits.size() / WORDS + 1; // The last block is a guard for rank1(n)
+  vector<uint64_t> newRanks(2 * blockN, 0);
+  vector<uint64_t> firsts; // The position of every SELECTSTEP-th one
+  uint64_t sum = 0;
+  for (size_t block = 0; block < blockN; ++block){
+    newRanks[2 * block] = sum;
+    uint64_t sub = 0;
+    for (size_t k = 0; k < WORDS; ++k){
+      const size_t w = block * WORDS + k;
+      if (k > 0){
+	newRanks[2 * block + 1] |= sub << (9 * (k - 1));
+      }
+      if (w < bits.size()){
+	const uint64_t ones = __builtin_popcountll(bits[w]);
+	const uint64_t r = (sum + sub + SELECTSTEP - 1) / SELECTSTEP * SELECTSTEP; // The next sampled rank
+	if (r < sum + sub + ones){
+	  firsts.push_back(64 * w + selectWord(bits[w], r - sum - sub));
+	}
+	sub += ones;
+      }
+    }
+    sum += sub;
+  }
+
+  vector<uint64_t> newSelects(firsts.size());
+  vector<uint64_t> newPositions;
+  for (size_t j = 0; j < firsts.size(); ++j){
+    const uint64_t end = (j + 1 < firsts.size()) ? firsts[j+1] : n;
+    if (end - firsts[j] < static_cast<uint64_t>(SPARSEBLOCKS) * BLOCKBITS){
+      newSelects[j] = firsts[j] / BLOCKBITS;
+      continue;
+    }
+    newSelects[j] = SPARSE | newPositions.size();
+    for (uint64_t w = firsts[j] / 64; w * 64 < end; ++w){
+      for (uint64_t x = bits[w]; x; x &= x - 1){
+	const uint64_t pos = 64 * w + __builtin_ctzll(x);
+	if (pos >= firsts[j] && pos < end) newPositions.push_back(pos);
+      }
+    }
+  }
+  ranks.swap(newRanks);
+  selects.swap(newSelects);
+  positions.swap(newPositions);
+}
+
+size_t BitVector::selectWord(uint64_t x, size_t i){
+  // Byte counts of x, and their prefix sums
+  uint64_t s = x - ((x >> 1) & 0x5555555555555555ULL);
+  s = (s & 0x3333333333333333ULL) + ((s >> 2) & 0x3333333333333333ULL);
+  s = (((s + (s >> 4)) & 0x0F0F0F0F0F0F0F0FULL) * 0x0101010101010101ULL);
+  size_t byte = 0;
+  while (((s >> (8 * byte)) & 0xFF) <= i) ++byte;
+  if (byte > 0){
+    i -= (s >> (8 * (byte - 1))) & 0xFF;
+  }
+  uint64_t b = (x >> (8 * byte)) & 0xFF;
+  for (; i > 0; --i){
+    b &= b - 1;
+  }
+  return 8 * byte + __builtin_ctzll(b);
+}
+
+size_t BitVector::select1(const size_t i) const{
+  const uint64_t sample = selects[i / SELECTSTEP];
+  if (sample & SPARSE){
+    return positions[(sample & ~SPARSE) + i % SELECTSTEP];
+  }
+
+  // The block is within SPARSEBLOCKS blocks from the sample, found by binary search
+  size_t lo = sample;
+  size_t hi = min(lo + SPARSEBLOCKS, ranks.size() / 2 - 1);
+  while (lo < hi){
+    const size_t mid = (lo + hi + 1) / 2;
+    if (ranks[2 * mid] <= i){
+      lo = mid;
+    } else {
+      hi = mid - 1;
+    }
+  }
+  size_t rest = i - ranks[2 * lo];
+  size_t k = 0;
+  for (; k + 1 < WORDS; ++k){
+    const size_t sub = (ranks[2 * lo + 1] >> (9 * k)) & 0x1FF;
+    if (sub > rest) break;
+  }
+  if (k > 0){
+    rest -= (ranks[2 * lo + 1] >> (9 * (k - 1))) & 0x1FF;
+  }
+  const size_t w = lo * WORDS + k;
+  return 64 * w + selectWord(bits[w], rest);
+}
+
+size_t BitVector::getSize() const{
+  return (bits.size() + ranks.size() + selects.size() + positions.size()) * sizeof(uint64_t);
+}
+
+int BitVector::save(ofstream& ofs) const{
+  if (!ofs.write((const char*)(&n), sizeof(n))) return -1;
+  if (bits.save(ofs) == -1) return -1;
+  if (ranks.save(ofs) == -1) return -1;
+  if (selects.save(ofs) == -1) return -1;
+  if (positions.save(ofs) == -1) return -1;
+  return 0;
+}
+
+int BitVector::load(MappedFile& mf){
+  const uint8_t* p = mf.get(sizeof(n), 1);
+  if (p == NULL) return -1;
+  memcpy(&n, p, sizeof(n));
+  if (bits.load(mf) == -1) return -1;
+  if (ranks.load(mf) == -1) return -1;
+  if (selects.load(mf) == -1) return -1;
+  if (positions.load(mf) == -1) return -1;
+  return 0;
+}
+
+}
@@ -0,0 +1,146 @@
+/*
+ * bitVector.hpp
+ * Copyright (c) 2009 Daisuke Okanohara All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef BIT_VECTOR_HPP__
+#define BIT_VECTOR_HPP__
+
+#include <vector>
+#include <fstream>
+#include <stdint.h>
+#include "mappedFile.hpp"
+#include "mappedVector.hpp"
+
+namespace SE{
+
+/**
+ * Succinct bit vector supporting rank and select in constant time.
+ * Bits are appended by push_back, and build() makes the rank directory
+ * (an absolute count and seven 9-bit relative counts for each 512 bits)
+ * and select samples for every SELECTSTEP ones. If SELECTSTEP ones span
+ * less than SPARSEBLOCKS blocks, the sample is their first block and
+ * select searches only these blocks. Otherwise their positions are stored
+ * as is, which takes at most 1/8 of the bits they span.
+ * Counting uses the POPCNT instruction when it is enabled (-mpopcnt).
+ */
+class BitVector {
+public:
+  BitVector(); ///< Constructor
+  ~BitVector(); ///< Destructor
+
+  /**
+   * Append a bit
+   * @param bit A bit to be appended
+   */
+  void push_back(const bool bit);
+
+  /**
+   * Build the rank directory and select samples after all bits are appended
+   */
+  void build();
+
+  /**
+   * @param i A position
+   * @return The i-th bit
+   */
+  bool get(const size_t i) const {
+    return (bits[i / 64] >> (i % 64)) & 1ULL;
+  }
+
+  /**
+   * @param i A position (<= size())
+   * @return The number of ones in [0, i)
+   */
+  size_t rank1(const size_t i) const {
+    const size_t w = i / 64;
+    const size_t block = w / WORDS;
+    size_t ret = ranks[2 * block];
+    if (w % WORDS != 0){
+      ret += (ranks[2 * block + 1] >> (9 * (w % WORDS - 1))) & 0x1FF;
+    }
+    if (i % 64 != 0){
+      ret += __builtin_popcountll(bits[w] << (64 - i % 64));
+    }
+    return ret;
+  }
+
+  /**
+   * @param i A position (<= size())
+   * @return The number of zeros in [0, i)
+   */
+  size_t rank0(const size_t i) const {
+    return i - rank1(i);
+  }
+
+  /**
+   * @param i A rank (< the number of ones)
+   * @return The position of the (i+1)-th one
+   */
+  size_t select1(const size_t i) const;
+
+  /**
+   * @return The number of ones
+   */
+  size_t getOneN() const {
+    return rank1(n);
+  }
+
+  /**
+   * @return The number of bits
+   */
+  size_t size() const {
+    return n;
+  }
+
+  /**
+   * @return The number of bytes used
+   */
+  size_t getSize() const;
+
+  int save(std::ofstream& ofs) const;
+  int load(MappedFile& mf);
+
+private:
+  enum {
+    BLOCKBITS = 512,             ///< Bits for each block of the rank directory
+    WORDS = BLOCKBITS / 64,      ///< Words in a block
+    SELECTSTEP = 512,            ///< Ones between select samples
+    SPARSEBLOCKS = 512           ///< Blocks spanned by SELECTSTEP ones to store their positions
+  };
+
+  static const uint64_t SPARSE = 1ULL << 63; ///< A sample pointing to stored positions
+
+  static size_t selectWord(uint64_t x, size_t i); ///< The position of the (i+1)-th one in x
+
+  MappedVector<uint64_t> bits;
+  MappedVector<uint64_t> ranks;   ///< The ones before each block and in its words (a guard block at last)
+  MappedVector<uint64_t> selects; ///< The first block, or SPARSE | an index in positions, for every SELECTSTEP ones
+  MappedVector<uint64_t> positions; ///< Positions of ones in sparse samples
+  uint64_t n;
+};
+
+}
+
+#endif // BIT_VECTOR_HPP__
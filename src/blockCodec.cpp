@@ -0,0 +1,107 @@
+/*
+ * blockCodec.cpp
+ * Copyright (c) 2009 Daisuke Okanohara All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cassert>
+#include "blockCodec.hpp"
+#include "varByte.hpp"
+#include "riceCode.hpp"
+#include "binaryPacking.hpp"
+#include "streamVByte.hpp"
+#include "eliasFano.hpp"
+
+using namespace std;
+
+namespace SE{
+
+void BlockCodec::encode(const Method method, const vector<uint32_t>& v, vector<uint8_t>& out){
+  assert(out.size() % alignment(method) == 0);
+  switch (method){
+  case VARBYTE:
+    VarByte::encode(v, out);
+    break;
+  case RICECODE:
+    RiceCode::encode(v, out);
+    break;
+  case BINARYPACKING:
+    BinaryPacking::encode(v, out);
+    break;
+  case STREAMVBYTE:
+    StreamVByte::encode(v, out);
+    break;
+  case ELIASFANO:
+    EliasFano::encode(v, out);
+    break;
+  default:
+    assert(false);
+  }
+}
+
+void BlockCodec::decode(const Method method, const uint8_t* p, const size_t size, 
+			uint32_t* v, const size_t n){
+  switch (method){
+  case VARBYTE:
+    VarByte::decode(p, size, v, n);
+    break;
+  case RICECODE:
+    RiceCode::decode(p, size, v, n);
+    break;
+  case BINARYPACKING:
+    BinaryPacking::decode(p, size, v, n);
+    break;
+  case STREAMVBYTE:
+    StreamVByte::decode(p, size, v, n);
+    break;
+  case ELIASFANO:
+    EliasFano::decode(p, size, v, n);
+    break;
+  default:
+    assert(false);
+  }
+}
+
+bool BlockCodec::hasNextGEQ(const Method method){
+  return method == ELIASFANO;
+}
+
+size_t BlockCodec::nextGEQ(const Method method, const uint8_t* p, const size_t size, 
+			   const uint32_t target, const size_t beg, uint32_t& value){
+  assert(method == ELIASFANO);
+  return EliasFano::nextGEQ(p, size, target, beg, value);
+}
+
+size_t BlockCodec::alignment(const Method method){
+  switch (method){
+  case RICECODE:
+  case BINARYPACKING:
+    return sizeof(uint32_t);
+  case ELIASFANO:
+    return sizeof(uint64_t);
+  default:
+    return 1;
+  }
+}
+
+}
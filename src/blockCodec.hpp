@@ -0,0 +1,84 @@
+/*
+ * blockCodec.hpp
+ * Copyright (c) 2009 Daisuke Okanohara All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef BLOCK_CODEC_HPP__
+#define BLOCK_CODEC_HPP__
+
+#include <vector>
+#include <stdint.h>
+#include <cstddef>
+
+namespace SE{
+
+/**
+ * Encode and decode compressed blocks stored in a contiguous arena.
+ * Each method is dispatched by a switch instead of virtual calls,
+ * and a block is given by its beginning and size in bytes.
+ */
+class BlockCodec {
+public:
+  enum Method {
+    NONE = 0,
+    VARBYTE = 1,
+    RICECODE = 2,
+    BINARYPACKING = 3,
+    STREAMVBYTE = 4,
+    ELIASFANO = 5
+  };
+
+  /**
+   * Append the code of v to out.
+   * out.size() should be a multiple of alignment(method)
+   */
+  static void encode(const Method method, const std::vector<uint32_t>& v, std::vector<uint8_t>& out);
+
+  /**
+   * Decode n positions from the block p of size bytes
+   */
+  static void decode(const Method method, const uint8_t* p, const size_t size, 
+		     uint32_t* v, const size_t n);
+
+  /**
+   * @return true if nextGEQ can be used
+   */
+  static bool hasNextGEQ(const Method method);
+
+  /**
+   * Find the first position >= target without decoding the whole block
+   * @return The index of the found position, or the number of positions if not found
+   */
+  static size_t nextGEQ(const Method method, const uint8_t* p, const size_t size, 
+			const uint32_t target, const size_t beg, uint32_t& value);
+
+  /**
+   * @return Alignment in bytes of the beginning of a block
+   */
+  static size_t alignment(const Method method);
+};
+
+}
+
+#endif // BLOCK_CODEC_HPP__
@@ -0,0 +1,200 @@
+/*
+ * eliasFano.cpp
+ * Copyright (c) 2009 Daisuke Okanohara All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <algorithm>
+#include "eliasFano.hpp"
+
+using namespace std;
+
+namespace SE{
+
+namespace {
+
+const size_t HEADER = 1;
+
+/// Position of the r-th (0-origin) one in x
+inline uint32_t selectWord(uint64_t x, uint32_t r){
+  for (; r > 0; --r){
+    x &= x - 1;
+  }
+  return static_cast<uint32_t>(__builtin_ctzll(x));
+}
+
+/// The number of bits for n values in [0, u) with l low bits
+inline uint64_t efBits(const uint64_t n, const uint64_t u, const uint32_t l){
+  return n * l + n + ((u - 1) >> l) + 1;
+}
+
+}
+
+uint32_t EliasFano::getFirst(const uint64_t* B){
+  return static_cast<uint32_t>(B[0]);
+}
+
+uint32_t EliasFano::getLowN(const uint64_t* B){
+  return static_cast<uint32_t>((B[0] >> 32) & 0x3F);
+}
+
+size_t EliasFano::getSize(const uint64_t* B){
+  return static_cast<size_t>(B[0] >> 38);
+}
+
+uint64_t EliasFano::getWord(const uint64_t* B, const size_t words, const size_t bitPos){
+  const size_t w = bitPos / 64;
+  const size_t o = bitPos % 64;
+  uint64_t x = B[w] >> o;
+  if (o > 0 && w + 1 < words){
+    x |= B[w+1] << (64 - o);
+  }
+  return x;
+}
+
+uint32_t EliasFano::getLow(const uint64_t* B, const size_t words, const size_t i){
+  const uint32_t l = getLowN(B);
+  if (l == 0) return 0;
+  const uint64_t x = getWord(B, words, HEADER * 64 + i * l);
+  return static_cast<uint32_t>(x & ((1ULL << l) - 1));
+}
+
+void EliasFano::encode(const vector<uint32_t>& v, vector<uint8_t>& out){
+  if (v.size() == 0) return;
+  const size_t n = v.size();
+  const uint32_t first = v.front();
+  // Positions are strictly increasing, so v[i] - first - i is non-decreasing
+  const uint64_t u = static_cast<uint64_t>(v.back() - first - (n - 1)) + 1;
+  uint32_t l = 0;
+  while (l < 32 && efBits(n, u, l + 1) <= efBits(n, u, l)){
+    l++;
+  }
+
+  const size_t highBeg = HEADER * 64 + n * l;
+  vector<uint64_t> B((highBeg + efBits(n, u, l) - n * l + 63) / 64, 0);
+  B[0] = first | (static_cast<uint64_t>(l) << 32) | (static_cast<uint64_t>(n) << 38);
+
+  for (size_t i = 0; i < n; ++i){
+    const uint32_t x = v[i] - first - static_cast<uint32_t>(i);
+    if (l > 0){
+      const uint64_t lx = x & ((1ULL << l) - 1);
+      const size_t bitPos = HEADER * 64 + i * l;
+      B[bitPos / 64] |= lx << (bitPos % 64);
+      if (bitPos % 64 + l > 64){
+	B[bitPos / 64 + 1] |= lx >> (64 - bitPos % 64);
+      }
+    }
+    const size_t h = highBeg + (x >> l) + i;
+    B[h / 64] |= 1ULL << (h % 64);
+  }
+
+  const uint8_t* p = reinterpret_cast<const uint8_t*>(&B[0]);
+  out.insert(out.end(), p, p + B.size() * sizeof(B[0]));
+}
+
+void EliasFano::decode(const uint8_t* p, const size_t size, uint32_t* v, const size_t vn){
+  const uint64_t* B = reinterpret_cast<const uint64_t*>(p);
+  const size_t words = size / sizeof(B[0]);
+  const size_t n = min(vn, getSize(B));
+  const uint32_t first = getFirst(B);
+  const uint32_t l = getLowN(B);
+  const size_t highBeg = HEADER * 64 + getSize(B) * l;
+  size_t i = 0;
+  for (size_t w = 0; i < n; ++w){
+    uint64_t x = getWord(B, words, highBeg + w * 64);
+    while (x && i < n){
+      const size_t h = w * 64 + __builtin_ctzll(x) - i;
+      v[i] = first + ((static_cast<uint32_t>(h) << l) | getLow(B, words, i)) + static_cast<uint32_t>(i);
+      x &= x - 1;
+      ++i;
+    }
+  }
+}
+
+size_t EliasFano::nextGEQ(const uint8_t* p, const size_t size, 
+			  const uint32_t target, const size_t beg, uint32_t& value){
+  const uint64_t* B = reinterpret_cast<const uint64_t*>(p);
+  const size_t words = size / sizeof(B[0]);
+  const size_t n = getSize(B);
+  if (beg >= n) return n;
+  const uint32_t first = getFirst(B);
+  const uint32_t l = getLowN(B);
+  const size_t highBeg = HEADER * 64 + n * l;
+  const size_t highWords = (words * 64 - highBeg + 63) / 64;
+  const uint32_t t = (target > first) ? target - first : 0;
+  // x[i] + i >= t needs x[i] >= t - (n-1)
+  const uint32_t th = ((t > n - 1) ? t - static_cast<uint32_t>(n - 1) : 0) >> l;
+
+  size_t w = 0;
+  size_t pos = 0; // Bit position in the high bits to start scanning ones
+  size_t i = 0;   // The number of ones before pos
+  if (th > 0){
+    // Find the (th)-th zero: elements before it have smaller high bits
+    uint32_t zeros = 0;
+    uint64_t x = 0;
+    for (; w < highWords; ++w){
+      x = getWord(B, words, highBeg + w * 64);
+      const uint32_t z = 64 - __builtin_popcountll(x);
+      if (zeros + z >= th) break;
+      zeros += z;
+    }
+    if (w == highWords) return n;
+    pos = w * 64 + selectWord(~x, th - zeros - 1) + 1;
+    i = pos - th;
+  }
+
+  if (i < beg){
+    // Jump to the beg-th one
+    size_t ones = 0;
+    uint64_t x = 0;
+    for (w = 0; ; ++w){
+      x = getWord(B, words, highBeg + w * 64);
+      const uint32_t o = __builtin_popcountll(x);
+      if (ones + o > beg) break;
+      ones += o;
+    }
+    pos = w * 64 + selectWord(x, static_cast<uint32_t>(beg - ones));
+    i = beg;
+  }
+
+  // Scan ones from pos
+  if (i >= n) return n;
+  w = pos / 64;
+  uint64_t x = getWord(B, words, highBeg + w * 64) & (~0ULL << (pos % 64));
+  while (i < n){
+    while (x == 0){
+      x = getWord(B, words, highBeg + (++w) * 64);
+    }
+    const size_t h = w * 64 + __builtin_ctzll(x) - i;
+    const uint32_t v = ((static_cast<uint32_t>(h) << l) | getLow(B, words, i)) + static_cast<uint32_t>(i);
+    if (v >= t){
+      value = first + v;
+      return i;
+    }
+    x &= x - 1;
+    ++i;
+  }
+  return n;
+}
+
+}
@@ -0,0 +1,75 @@
+/*
+ * eliasFano.hpp
+ * Copyright (c) 2009 Daisuke Okanohara All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef ELIAS_FANO_HPP__
+#define ELIAS_FANO_HPP__
+
+#include <vector>
+#include <cstddef>
+#include <stdint.h>
+
+namespace SE{
+
+/**
+ * Elias-Fano Code
+ * x[i] = v[i] - v[0] - i (non-decreasing) is split into l low bits,
+ * which are stored as is, and high bits, which are stored in unary
+ * as a bit vector where the i-th one is at (x[i] >> l) + i.
+ * nextGEQ skips to the target's bucket by select on the high bits.
+ */
+class EliasFano {
+public:
+  /**
+   * Append the code of v to out (for blocks in an arena, aligned to 8 bytes)
+   */
+  static void encode(const std::vector<uint32_t>& v, std::vector<uint8_t>& out);
+
+  /**
+   * Decode n positions from the code p of size bytes (aligned to 8 bytes)
+   */
+  static void decode(const uint8_t* p, const size_t size, uint32_t* v, const size_t n);
+
+  /**
+   * Find the first position >= target in the code p of size bytes (aligned to 8 bytes)
+   * without decoding the whole block
+   * @param beg An index in the block to start searching
+   * @param value The found position
+   * @return The index of the found position, or the number of positions if not found
+   */
+  static size_t nextGEQ(const uint8_t* p, const size_t size, 
+			const uint32_t target, const size_t beg, uint32_t& value);
+
+private:
+  static uint32_t getFirst(const uint64_t* B);
+  static uint32_t getLowN(const uint64_t* B);
+  static size_t getSize(const uint64_t* B);
+  static uint32_t getLow(const uint64_t* B, const size_t words, const size_t i);
+  static uint64_t getWord(const uint64_t* B, const size_t words, const size_t bitPos);
+};
+
+}
+
+#endif // ELIAS_FANO_HPP__
@@ -0,0 +1,263 @@
+/*
+ * fmIndex.cpp
+ * Copyright (c) 2009 Daisuke Okanohara All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <algorithm>
+#include "sais.hxx"
+#include "suffixSorter.hpp"
+#include "fmIndex.hpp"
+
+using namespace std;
+
+namespace SE{
+
+FMIndex::FMIndex() : dollarRow(0), textSize(0), sampleRate(32), threadN(1) {
+}
+
+FMIndex::~FMIndex(){
+}
+
+void FMIndex::addIndex(const std::vector<uint8_t>& content){
+}
+
+Minise* FMIndex::createPart() const{
+  return new FMIndex;
+}
+
+void FMIndex::setSampleRate(const uint32_t rate){
+  sampleRate = rate;
+}
+
+void FMIndex::setThreadN(const int threadN_){
+  threadN = threadN_;
+}
+
+int FMIndex::build(){
+  if (sampleRate == 0){
+    what_ << "sample rate should be positive";
+    return -1;
+  }
+  if (checkTextSize32() == -1) return -1;
+
+  const size_t n = text.size();
+  vector<uint32_t> SA(n);
+  if (n > 0 && threadN > 1){
+    if (parallelSuffixSort(text.begin(), &SA[0], n, threadN) == -1){
+      what_ << "cannot create threads";
+      return -1;
+    }
+  } else if (n > 0 && saisxx(text.begin(), SA.begin(), (int)n, 0x100) != 0){
+    what_ << "saisxx error";
+    return -1;
+  }
+
+  // The row 0 is $, and the row i+1 is the suffix SA[i]
+  vector<uint8_t> B(n + 1);
+  vector<uint32_t> newC(0x101, 1);
+  B[0] = (n > 0) ? text[n-1] : 0;
+  dollarRow = 0;
+  for (size_t i = 0; i < n; ++i){
+    if (SA[i] == 0){
+      dollarRow = static_cast<uint32_t>(i + 1);
+      B[i+1] = 0;
+    } else {
+      B[i+1] = text[SA[i]-1];
+    }
+    newC[text[i] + 1]++;
+  }
+  for (size_t c = 1; c < newC.size(); ++c){
+    newC[c] += newC[c-1] - 1; // 1 for $ is counted only once
+  }
+  C.swap(newC);
+
+  vector<uint32_t> newSA;
+  vector<uint32_t> newISA(n / sampleRate + 1);
+  sampled = BitVector();
+  for (size_t i = 0; i <= n; ++i){
+    const uint32_t pos = (i == 0) ? static_cast<uint32_t>(n) : SA[i-1];
+    const bool isSampled = (pos % sampleRate == 0);
+    sampled.push_back(isSampled);
+    if (isSampled){
+      newSA.push_back(pos);
+      newISA[pos / sampleRate] = static_cast<uint32_t>(i);
+    }
+  }
+  sampled.build();
+  saSamples.swap(newSA);
+  isaSamples.swap(newISA);
+  vector<uint32_t>().swap(SA);
+
+  bwt.build(B);
+  textSize = static_cast<uint32_t>(n);
+  text.clear(); // Recovered from the BWT
+  return 0;
+}
+
+size_t FMIndex::occ(const uint8_t c, const size_t i) const{
+  return bwt.rank(c, i) - ((c == 0 && i > dollarRow) ? 1 : 0);
+}
+
+size_t FMIndex::locate(size_t row) const{
+  size_t steps = 0;
+  while (!sampled.get(row)){
+    // LF mapping: the row of the previous position
+    size_t r = 0;
+    const uint8_t c = bwt.accessRank(row, r);
+    row = C[c] + r - ((c == 0 && row > dollarRow) ? 1 : 0);
+    ++steps;
+  }
+  return saSamples[sampled.rank1(row)] + steps;
+}
+
+void FMIndex::extract(const size_t beg, const size_t end, string& ret) const{
+  if (beg >= end) return;
+  // Walk backward from the first sampled position at or after end
+  size_t pos = (end + sampleRate - 1) / sampleRate * sampleRate;
+  size_t row = 0;
+  if (pos >= textSize){
+    pos = textSize; // The row of $
+  } else {
+    row = isaSamples[pos / sampleRate];
+  }
+
+  string rev;
+  rev.reserve(pos - beg);
+  for (; pos > beg; --pos){
+    size_t r = 0;
+    const uint8_t c = bwt.accessRank(row, r); // text[pos-1]
+    if (pos <= end){
+      rev.push_back(static_cast<char>(c));
+    }
+    row = C[c] + r - ((c == 0 && row > dollarRow) ? 1 : 0);
+  }
+  ret.append(rev.rbegin(), rev.rend());
+}
+
+void FMIndex::search(const vector<uint8_t>& query, ResultSet& res, QueryProfile* prof){
+  res.clear();
+  if (query.size() == 0) return;
+  vector<uint32_t> poses;
+  {
+    ProfileTimer timer(prof, QueryProfile::FETCH);
+
+    // Backward search of rows [sp, ep) beginning with the query
+    size_t sp = 0;
+    size_t ep = textSize + 1;
+    for (size_t i = query.size(); i > 0 && sp < ep; --i){
+      const uint8_t c = query[i-1];
+      sp = C[c] + occ(c, sp);
+      ep = C[c] + occ(c, ep);
+    }
+    if (prof) prof->addCount(QueryProfile::SA_PROBES, query.size());
+    if (sp >= ep) return;
+
+    poses.reserve(ep - sp);
+    for (size_t row = sp; row < ep; ++row){
+      poses.push_back(static_cast<uint32_t>(locate(row)));
+    }
+    sort(poses.begin(), poses.end());
+  }
+  decodeDoc(poses, res, prof);
+}
+
+void FMIndex::getSnippet(const uint32_t docID, const int offset, 
+			 const uint32_t len, string& ret) const{
+  const uint64_t beg = docOffsets[docID] + offset;
+  const uint64_t end = std::min(beg + len, docOffsets[docID+1]);
+  extract(beg, end, ret);
+}
+
+double FMIndex::getAvgDocLength() const{
+  if (docN == 0) return 0.0;
+  return static_cast<double>(docOffsets[docN] - docN) / docN;
+}
+
+int FMIndex::save(const char* fileName){
+  ofstream ofs(fileName);
+  if (!ofs){
+    what_ << "cannot open " << fileName;
+    return -1;
+  }
+
+  if (write(FMINDEX, "indexType", ofs) == -1) return -1;
+  if (write(docOffsets, "docOffsets", ofs) == -1) return -1;
+  if (write(titles, "titles", ofs) == -1) return -1;
+  if (write(textSize, "textSize", ofs) == -1) return -1;
+  if (write(sampleRate, "sampleRate", ofs) == -1) return -1;
+  if (write(dollarRow, "dollarRow", ofs) == -1) return -1;
+  if (write(C, "C", ofs) == -1) return -1;
+  if (write(saSamples, "saSamples", ofs) == -1) return -1;
+  if (write(isaSamples, "isaSamples", ofs) == -1) return -1;
+  if (sampled.save(ofs) == -1 || bwt.save(ofs) == -1){
+    what_ << "write error: bwt";
+    return -1;
+  }
+  return 0;
+}
+
+int FMIndex::load(const char* fileName){
+  if (indexFile.open(fileName) == -1){
+    what_ << "cannot open " << fileName;
+    return -1;
+  }
+
+  int indexType = -1;
+  if (read(indexType, "indexType", indexFile) == -1) return -1;
+  if (indexType != FMINDEX){
+    what_ << "indexType is not FM-INDEX";
+    return -1;
+  }
+  if (read(docOffsets, "docOffsets", indexFile) == -1) return -1;
+  if (read(titles, "titles", indexFile) == -1) return -1;
+  if (read(textSize, "textSize", indexFile) == -1) return -1;
+  if (read(sampleRate, "sampleRate", indexFile) == -1) return -1;
+  if (read(dollarRow, "dollarRow", indexFile) == -1) return -1;
+  if (read(C, "C", indexFile) == -1) return -1;
+  if (read(saSamples, "saSamples", indexFile) == -1) return -1;
+  if (read(isaSamples, "isaSamples", indexFile) == -1) return -1;
+  if (sampled.load(indexFile) == -1 || bwt.load(indexFile) == -1){
+    what_ << "read error: bwt";
+    return -1;
+  }
+
+  docN = static_cast<uint32_t>(docOffsets.size())-1;
+  return 0;
+}
+
+string FMIndex::getIndexName() const{
+  return string("FM-index");
+}
+
+size_t FMIndex::getIndexSize() const {
+  size_t ret = Minise::getIndexSize(); // Calculate Basic Class Size()
+  ret += bwt.getSize();
+  ret += sampled.getSize();
+  ret += C.size() * sizeof(uint32_t);
+  ret += saSamples.size() * sizeof(uint32_t);
+  ret += isaSamples.size() * sizeof(uint32_t);
+  return ret;
+}
+
+}
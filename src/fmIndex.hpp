@@ -0,0 +1,92 @@
+/*
+ * fmIndex.hpp
+ * Copyright (c) 2009 Daisuke Okanohara All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef FM_INDEX_HPP__
+#define FM_INDEX_HPP__
+
+#include "miniseBase.hpp"
+#include "waveletMatrix.hpp"
+
+namespace SE{
+
+/**
+ * FM-index.
+ * The BWT of the text is stored in a wavelet matrix, and patterns are
+ * counted by backward search. Positions are located by sampled SA, and
+ * snippets are extracted from sampled inverse SA, so the text is not kept.
+ */
+class FMIndex : public Minise {
+public:
+  FMIndex(); ///< Constructor
+  ~FMIndex(); ///< Destructor
+
+  int save(const char* fileName); ///< Save the index to file
+  int load(const char* fileName); ///< Load the index from file
+  int build(); ///< Build the BWT and samples, and free the text
+
+  /**
+   * Sample every rate-th position of SA and inverse SA.
+   * Locating a position and extracting a snippet take up to rate steps.
+   * @param rate Sampling rate (> 0)
+   */
+  void setSampleRate(const uint32_t rate);
+
+  /**
+   * Build SA by several threads instead of saisxx (not saved)
+   * @param threadN The number of threads
+   */
+  void setThreadN(const int threadN);
+
+  void getSnippet(const uint32_t docID, const int offset, 
+		  const uint32_t len, std::string& ret) const;
+  double getAvgDocLength() const;
+  std::string getIndexName() const;
+  size_t getIndexSize() const;
+
+private:
+  void search(const std::vector<uint8_t>& query, ResultSet& ret, QueryProfile* prof);
+  void addIndex(const std::vector<uint8_t>& content);
+  Minise* createPart() const;
+
+  size_t occ(const uint8_t c, const size_t i) const; ///< The number of c in BWT[0, i)
+  size_t locate(size_t row) const;                   ///< The text position of a row
+  void extract(const size_t beg, const size_t end, std::string& ret) const;
+
+  // Rows are suffixes of text$ in sorted order, where $ precedes all bytes.
+  WaveletMatrix bwt;                ///< BWT of text$ (with 0 at the row of $)
+  MappedVector<uint32_t> C;         ///< The first row of suffixes beginning with each byte (257)
+  BitVector sampled;                ///< Rows whose positions are multiples of sampleRate
+  MappedVector<uint32_t> saSamples; ///< Positions of sampled rows
+  MappedVector<uint32_t> isaSamples; ///< Rows of positions 0, sampleRate, 2*sampleRate, ...
+  uint32_t dollarRow;               ///< The row where BWT is $ (the row of position 0)
+  uint32_t textSize;
+  uint32_t sampleRate;
+  int threadN; ///< The number of threads to build SA
+};
+
+}
+
+#endif // FM_INDEX_HPP__
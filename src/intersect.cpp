@@ -0,0 +1,236 @@
+/*
+ * intersect.cpp
+ * Copyright (c) 2009 Daisuke Okanohara All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "intersect.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define MINISE_X86 1
+#endif
+
+namespace SE{
+
+namespace {
+
+/// The first position i >= beg such that p[i] >= target
+inline size_t gallop(const uint32_t* p, const size_t n, size_t beg, const uint32_t target){
+  if (beg >= n || p[beg] >= target) return beg;
+  size_t step = 1;
+  size_t lo = beg;    // p[lo] < target
+  size_t hi = beg + 1;
+  while (hi < n && p[hi] < target){
+    lo = hi;
+    step <<= 1;
+    hi = beg + step;
+  }
+  if (hi > n) hi = n;
+  // p[lo] < target <= p[hi] (or hi == n)
+  while (lo + 1 < hi){
+    const size_t mid = lo + (hi - lo) / 2;
+    if (p[mid] < target){
+      lo = mid;
+    } else {
+      hi = mid;
+    }
+  }
+  return hi;
+}
+
+}
+
+size_t intersectGallop(const uint32_t* a, const size_t an, const uint32_t* b, const size_t bn,
+		       const uint32_t shift, uint32_t* out){
+  size_t k = 0;
+  if (an <= bn){
+    size_t j = 0;
+    for (size_t i = 0; i < an; ++i){
+      const uint32_t target = a[i] + shift;
+      j = gallop(b, bn, j, target);
+      if (j == bn) break;
+      if (b[j] == target){
+	out[k++] = a[i];
+      }
+    }
+  } else {
+    size_t i = 0;
+    for (size_t j = 0; j < bn; ++j){
+      if (b[j] < shift) continue;
+      const uint32_t target = b[j] - shift;
+      i = gallop(a, an, i, target);
+      if (i == an) break;
+      if (a[i] == target){
+	out[k++] = target;
+      }
+    }
+  }
+  return k;
+}
+
+size_t intersectMerge(const uint32_t* a, const size_t an, const uint32_t* b, const size_t bn,
+		      const uint32_t shift, uint32_t* out){
+  size_t i = 0;
+  size_t j = 0;
+  size_t k = 0;
+  while (i < an && j < bn){
+    const uint32_t x = a[i] + shift;
+    const uint32_t y = b[j];
+    out[k] = a[i];
+    k += (x == y);
+    i += (x <= y);
+    j += (y <= x);
+  }
+  return k;
+}
+
+#ifdef MINISE_X86
+
+namespace {
+
+/// Emit a[bit] for each bit set in mask
+inline size_t emit(const uint32_t* a, unsigned int mask, uint32_t* out){
+  size_t k = 0;
+  while (mask){
+    out[k++] = a[__builtin_ctz(mask)];
+    mask &= mask - 1;
+  }
+  return k;
+}
+
+__attribute__((target("sse2")))
+size_t intersectSSE2(const uint32_t* a, const size_t an, const uint32_t* b, const size_t bn,
+		     const uint32_t shift, uint32_t* out){
+  size_t i = 0;
+  size_t j = 0;
+  size_t k = 0;
+  const __m128i s = _mm_set1_epi32(static_cast<int>(shift));
+  while (i + 4 <= an && j + 4 <= bn){
+    const __m128i va = _mm_add_epi32(_mm_loadu_si128((const __m128i*)(a + i)), s);
+    const __m128i vb = _mm_loadu_si128((const __m128i*)(b + j));
+    // Compare all pairs by rotating vb
+    const __m128i m01 = _mm_or_si128(_mm_cmpeq_epi32(va, vb),
+				     _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1))));
+    const __m128i m23 = _mm_or_si128(_mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2))),
+				     _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(2, 1, 0, 3))));
+    const unsigned int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_or_si128(m01, m23)));
+    k += emit(a + i, mask, out + k);
+
+    const uint32_t amax = a[i + 3] + shift;
+    const uint32_t bmax = b[j + 3];
+    i += (amax <= bmax) << 2;
+    j += (bmax <= amax) << 2;
+  }
+  return k + intersectMerge(a + i, an - i, b + j, bn - j, shift, out + k);
+}
+
+__attribute__((target("avx2")))
+size_t intersectAVX2(const uint32_t* a, const size_t an, const uint32_t* b, const size_t bn,
+		     const uint32_t shift, uint32_t* out){
+  size_t i = 0;
+  size_t j = 0;
+  size_t k = 0;
+  const __m256i s = _mm256_set1_epi32(static_cast<int>(shift));
+  const __m256i rot = _mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 0);
+  while (i + 8 <= an && j + 8 <= bn){
+    const __m256i va = _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(a + i)), s);
+    __m256i vb = _mm256_loadu_si256((const __m256i*)(b + j));
+    __m256i m = _mm256_cmpeq_epi32(va, vb);
+    for (int r = 1; r < 8; ++r){
+      vb = _mm256_permutevar8x32_epi32(vb, rot);
+      m = _mm256_or_si256(m, _mm256_cmpeq_epi32(va, vb));
+    }
+    const unsigned int mask = _mm256_movemask_ps(_mm256_castsi256_ps(m));
+    k += emit(a + i, mask, out + k);
+
+    const uint32_t amax = a[i + 7] + shift;
+    const uint32_t bmax = b[j + 7];
+    i += (amax <= bmax) << 3;
+    j += (bmax <= amax) << 3;
+  }
+  return k + intersectSSE2(a + i, an - i, b + j, bn - j, shift, out + k);
+}
+
+bool hasAVX2(){
+  static const bool ret = __builtin_cpu_supports("avx2");
+  return ret;
+}
+
+bool hasSSE2(){
+  static const bool ret = __builtin_cpu_supports("sse2");
+  return ret;
+}
+
+}
+
+size_t intersectSIMD(const uint32_t* a, const size_t an, const uint32_t* b, const size_t bn,
+		     const uint32_t shift, uint32_t* out){
+  if (hasAVX2()){
+    return intersectAVX2(a, an, b, bn, shift, out);
+  } else if (hasSSE2()){
+    return intersectSSE2(a, an, b, bn, shift, out);
+  }
+  return intersectMerge(a, an, b, bn, shift, out);
+}
+
+const char* intersectSIMDName(){
+  if (hasAVX2()) return "avx2";
+  if (hasSSE2()) return "sse2";
+  return "none";
+}
+
+#else
+
+size_t intersectSIMD(const uint32_t* a, const size_t an, const uint32_t* b, const size_t bn,
+		     const uint32_t shift, uint32_t* out){
+  return intersectMerge(a, an, b, bn, shift, out);
+}
+
+const char* intersectSIMDName(){
+  return "none";
+}
+
+#endif // MINISE_X86
+
+size_t intersect(const uint32_t* a, const size_t an, const uint32_t* b, const size_t bn,
+		 const uint32_t shift, uint32_t* out, const IntersectMethod method){
+  if (an == 0 || bn == 0) return 0;
+  switch (method){
+  case INTERSECT_GALLOP:
+    return intersectGallop(a, an, b, bn, shift, out);
+  case INTERSECT_MERGE:
+    return intersectMerge(a, an, b, bn, shift, out);
+  case INTERSECT_SIMD:
+    return intersectSIMD(a, an, b, bn, shift, out);
+  default:
+    break;
+  }
+
+  if (an >= bn * GALLOP_RATIO || bn >= an * GALLOP_RATIO){
+    return intersectGallop(a, an, b, bn, shift, out);
+  }
+  return intersectSIMD(a, an, b, bn, shift, out);
+}
+
+}
@@ -0,0 +1,78 @@
+/*
+ * intersect.hpp
+ * Copyright (c) 2009 Daisuke Okanohara All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef INTERSECT_HPP__
+#define INTERSECT_HPP__
+
+#include <cstddef>
+#include <stdint.h>
+
+namespace SE{
+
+/**
+ * Intersection kernels for sorted lists of positions.
+ * Each kernel stores every x in a such that x + shift is in b to out
+ * in increasing order, and returns the number of stored values.
+ * a and b must be strictly increasing, and out must have space for min(an, bn) values.
+ */
+enum IntersectMethod {
+  INTERSECT_AUTO   = 0, ///< Select by the length ratio of the lists
+  INTERSECT_GALLOP = 1, ///< Exponential search of the shorter list in the longer list
+  INTERSECT_MERGE  = 2, ///< Branchless linear merge
+  INTERSECT_SIMD   = 3  ///< Block-by-block comparison with SSE2/AVX2
+};
+
+enum {
+  GALLOP_RATIO = 32 ///< INTERSECT_AUTO uses galloping if the longer list is GALLOP_RATIO times longer
+};
+
+size_t intersectGallop(const uint32_t* a, const size_t an, const uint32_t* b, const size_t bn,
+		       const uint32_t shift, uint32_t* out);
+
+size_t intersectMerge(const uint32_t* a, const size_t an, const uint32_t* b, const size_t bn,
+		      const uint32_t shift, uint32_t* out);
+
+/**
+ * Use AVX2 if the CPU supports it, SSE2 otherwise.
+ * Same as intersectMerge on CPUs without SSE2.
+ */
+size_t intersectSIMD(const uint32_t* a, const size_t an, const uint32_t* b, const size_t bn,
+		     const uint32_t shift, uint32_t* out);
+
+/**
+ * Intersect using a given method
+ */
+size_t intersect(const uint32_t* a, const size_t an, const uint32_t* b, const size_t bn,
+		 const uint32_t shift, uint32_t* out, const IntersectMethod method);
+
+/**
+ * @return A name of the SIMD instruction set used by intersectSIMD ("none" if not available)
+ */
+const char* intersectSIMDName();
+
+}
+
+#endif // INTERSECT_HPP__
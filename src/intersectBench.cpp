@@ -0,0 +1,193 @@
+/*
+ * intersectBench.cpp
+ * Copyright (c) 2009 Daisuke Okanohara All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <iomanip>
+#include "minise.hpp"
+#include "intersect.hpp"
+#include "cmdline.h"
+#include "timer.hpp"
+
+using namespace std;
+using namespace SE;
+using namespace cmdline;
+
+const IntersectMethod methods[] = {INTERSECT_AUTO, INTERSECT_GALLOP, INTERSECT_MERGE, INTERSECT_SIMD};
+const char* methodNames[] = {"auto", "gallop", "merge", "simd"};
+const size_t methodN = 4;
+
+/// Deterministic pseudo random numbers
+class XorShift{
+public:
+  XorShift() : x(123456789) {}
+  uint32_t next(){
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return x;
+  }
+private:
+  uint32_t x;
+};
+
+/// n strictly increasing positions with average gap
+void genList(XorShift& rnd, const size_t n, const uint32_t gap, vector<uint32_t>& v){
+  v.resize(n);
+  uint32_t cur = 0;
+  for (size_t i = 0; i < n; ++i){
+    cur += 1 + rnd.next() % (2 * gap);
+    v[i] = cur;
+  }
+}
+
+void benchSynthetic(const size_t shortN, const int repeat){
+  cout << "synthetic lists (short list: " << shortN << " positions, " 
+       << repeat << " times)" << endl;
+  cout << setw(8) << "ratio";
+  for (size_t m = 0; m < methodN; ++m){
+    cout << setw(12) << methodNames[m];
+  }
+  cout << setw(10) << "hit" << "  (milli seconds)" << endl;
+
+  XorShift rnd;
+  const size_t ratios[] = {1, 2, 4, 16, 64, 256, 1024};
+  for (size_t r = 0; r < sizeof(ratios) / sizeof(ratios[0]); ++r){
+    const size_t longN = shortN * ratios[r];
+    vector<uint32_t> a, b;
+    genList(rnd, shortN, static_cast<uint32_t>(4 * ratios[r]), a);
+    genList(rnd, longN, 4, b);
+    vector<uint32_t> out(shortN);
+
+    cout << setw(8) << ratios[r];
+    size_t hit = 0;
+    for (size_t m = 0; m < methodN; ++m){
+      double start = gettimeofday_sec();
+      size_t n = 0;
+      for (int i = 0; i < repeat; ++i){
+	n = intersect(&a[0], a.size(), &b[0], b.size(), 0, &out[0], methods[m]);
+      }
+      cout << setw(12) << fixed << setprecision(3) << (gettimeofday_sec() - start) * 1000;
+      if (m == 0){
+	hit = n;
+      } else if (n != hit){
+	cout << "(mismatch)";
+      }
+    }
+    cout << setw(10) << hit << endl;
+  }
+  cout << endl;
+}
+
+int benchIndex(const string& index, const int repeat){
+  Minise::IndexType indexType = Minise::QUICKSEARCH;
+  if (getIndexType(index.c_str(), indexType) == -1){
+    cerr << "benchIndex read error: " << index << endl;
+    return -1;
+  }
+  if (indexType != Minise::ONEGRAM &&
+      indexType != Minise::TWOGRAM &&
+      indexType != Minise::INVERTEDFILE){
+    cerr << "not an inverted file (1gram|2gram|inv): " << index << endl;
+    return -1;
+  }
+
+  InvertedFile inv;
+  Minise& ms(inv);
+  if (ms.load(index.c_str()) == -1){
+    cerr << ms.what() << endl;
+    return -1;
+  }
+
+  vector<string> queries;
+  string query;
+  while (getline(cin, query)){
+    queries.push_back(query);
+  }
+
+  cout << "method: " << ms.getIndexName() << endl
+       << " index: " << index << endl
+       << "  simd: " << intersectSIMDName() << endl
+       << "  time: " << repeat << " times for " << queries.size() << " queries" << endl;
+
+  ResultSet ret;
+  SearchContext ctx;
+  vector<size_t> hits;
+  for (size_t m = 0; m < methodN; ++m){
+    inv.setIntersectMethod(methods[m]);
+    double start = gettimeofday_sec();
+    size_t hit = 0;
+    for (int i = 0; i < repeat; ++i){
+      hit = 0;
+      for (size_t q = 0; q < queries.size(); ++q){
+	ms.search(queries[q].c_str(), queries[q].size(), ret, ctx);
+	hit += ret.getOffsetN();
+      }
+    }
+    cout << setw(8) << methodNames[m] << ": " 
+	 << (gettimeofday_sec() - start) * 1000 << " milli seconds. " 
+	 << hit << " positions.";
+    if (m > 0 && hit != hits[0]){
+      cout << " (mismatch)";
+    }
+    cout << endl;
+    hits.push_back(hit);
+  }
+  cout << endl;
+  return 0;
+}
+
+int main(int argc, char* argv[]){
+  parser p;
+  p.set_progam_name(string("minise_intersect_bench"));
+  p.add<string>("index", 'i', "Index file (inv|1gram|2gram). Queries are read from stdin ", false, "");
+  p.add<int>("repeat", 'r', "Repeat count ", false, 10);
+  p.add<int>("synthetic", 's', "Length of a short list for synthetic lists (0: skip) ", false, 10000);
+  p.add("help", 'h', "Print help");
+
+  if (!p.parse(argc, argv) || p.exist("help")){
+    if (p.exist("help")){
+      cerr << p.usage() << endl;
+    } else {
+      cerr << p.error() << p.usage() << endl;
+    }
+    return -1;
+  }
+
+  const int repeat = p.get<int>("repeat");
+  if (p.get<int>("synthetic") > 0){
+    benchSynthetic(p.get<int>("synthetic"), repeat);
+  }
+
+  if (p.get<string>("index") != ""){
+    if (benchIndex(p.get<string>("index"), repeat) == -1){
+      return -1;
+    }
+  }
+
+  return 0;
+}
@@ -27,21 +27,17 @@
 #include <algorithm>
 #include <cassert>
 #include "invertedFile.hpp"
+#include "topKHeap.hpp"
 
 using namespace std;
 
 namespace SE{
 
-InvertedFile::InvertedFile() : cm(NONE){
+InvertedFile::InvertedFile() : totalLength(0), boundDocN(0), cm(NONE), im(INTERSECT_AUTO){
   buf.resize(BLOCKSIZE);
 }
 
 InvertedFile::~InvertedFile(){
-  for (size_t i = 0; i < cPosList.size(); ++i){
-    for (size_t j = 0; j < cPosList[i].size(); ++j){
-      delete cPosList[i][j];
-    }
-  }
 }
 
 void  InvertedFile::addIndex(const std::vector<uint8_t>& content){
@@ -49,162 +45,465 @@ void  InvertedFile::addIndex(const std::vector<uint8_t>& content){
 
   parseResult parsed;
   parse(content, true, parsed);
+  docLengths.push_back(static_cast<uint32_t>(parsed.size()));
+  totalLength += parsed.size();
+
+  if (pt == SEPARATED){
+    // Words are indexed by their ordinals so that phrases are found by shifted merges
+    const uint32_t ord = static_cast<uint32_t>(wordOffsets.size());
+    for (size_t i = 0; i < parsed.size(); ++i){
+      wordOffsets.push_back(parsed[i].second + offset);
+      parsed[i].second = ord + static_cast<uint32_t>(i);
+    }
+    wordOffsets.push_back(offset + static_cast<uint32_t>(content.size())); // Guard between documents
+  }
   if (parsed.size() == 0) return;
 
-  for (size_t i = 0; i < parsed.size(); ++i){
-    parsed[i].second += offset;
+  if (pt != SEPARATED){
+    for (size_t i = 0; i < parsed.size(); ++i){
+      parsed[i].second += offset;
+    }
   }
-  if (parsed.size() == 0) return;
 
   sort(parsed.begin(), parsed.end());
   
   if (parsed.back().first >= posList.size()){
     uint32_t maxID = parsed.back().first+1;
     posList.resize(maxID);
-    cPosList.resize(maxID);
-    blockFront.resize(maxID);
   }
 
   for (size_t i = 0; i < parsed.size(); ++i){
-    uint32_t id = parsed[i].first;
-    posList[id].push_back(parsed[i].second);
-    if (cm != NONE && posList[id].size() >= BLOCKSIZE) {
-      CompressedBlock* cb = NULL;
-      if (cm == VARBYTE){
-	cb = new VarByte(posList[id]);
-      } else if (cm == RICECODE){
-	cb = new RiceCode(posList[id]);
-      } else {
-	assert(false);
-      }
-      cPosList[id].push_back(cb);
-      blockFront[id].push_back(posList[id].back());
-      posList[id].clear();
+    addPosition(parsed[i].first, parsed[i].second);
+  }
+}
+
+void InvertedFile::addPosition(const uint32_t id, const uint32_t pos){
+  posList[id].push_back(pos);
+  if (cm != NONE && posList[id].size() >= BLOCKSIZE) {
+    const BlockCodec::Method method = static_cast<BlockCodec::Method>(cm);
+    buf.assign(posList[id].begin(), posList[id].end());
+    code.clear();
+    BlockCodec::encode(method, buf, code);
+
+    // Blocks are appended in order of arrival, and grouped by terms in build().
+    // Each block is padded so that the next block begins at its alignment.
+    const size_t align = BlockCodec::alignment(method);
+    code.resize((code.size() + align - 1) / align * align, 0);
+    if (blockOffsets.empty()) blockOffsets.push_back(0);
+    blockData.append(code.begin(), code.end());
+    blockOffsets.push_back(blockData.size());
+    blockFront.push_back(posList[id].back());
+    blockTerms.push_back(id);
+    posList[id].clear();
+  }
+}
+
+void InvertedFile::sortBlocks(){
+  const size_t blockN = blockFront.size();
+  const size_t termN_ = posList.size();
+  if (blockTerms.size() < blockN){
+    // Blocks before the last build() are already grouped by terms
+    vector<uint32_t> sortedTerms;
+    sortedTerms.reserve(blockN);
+    for (uint32_t id = 0; id + 1 < termBlocks.size(); ++id){
+      sortedTerms.insert(sortedTerms.end(), termBlocks[id+1] - termBlocks[id], id);
     }
+    blockTerms.insert(blockTerms.begin(), sortedTerms.begin(), sortedTerms.end());
+  }
+  assert(blockTerms.size() == blockN);
+
+  vector<uint32_t> newTermBlocks(termN_ + 1, 0);
+  for (size_t i = 0; i < blockN; ++i){
+    newTermBlocks[blockTerms[i] + 1]++;
+  }
+  for (size_t id = 0; id < termN_; ++id){
+    newTermBlocks[id+1] += newTermBlocks[id];
+  }
+
+  // Stable counting sort of blocks by terms
+  vector<uint32_t> order(blockN);
+  vector<uint32_t> next(newTermBlocks.begin(), newTermBlocks.end() - 1);
+  for (size_t i = 0; i < blockN; ++i){
+    order[next[blockTerms[i]]++] = static_cast<uint32_t>(i);
   }
+
+  vector<uint8_t> newData;
+  vector<uint64_t> newOffsets;
+  vector<uint32_t> newFront(blockN);
+  newData.reserve(blockData.size());
+  newOffsets.reserve(blockN + 1);
+  for (size_t i = 0; i < blockN; ++i){
+    const uint32_t b = order[i];
+    newOffsets.push_back(newData.size());
+    newData.insert(newData.end(), 
+		   blockData.begin() + blockOffsets[b], blockData.begin() + blockOffsets[b+1]);
+    newFront[i] = blockFront[b];
+  }
+  if (blockN > 0){
+    newOffsets.push_back(newData.size());
+  }
+
+  blockData.swap(newData);
+  blockOffsets.swap(newOffsets);
+  blockFront.swap(newFront);
+  termBlocks.swap(newTermBlocks);
+  vector<uint32_t>().swap(blockTerms);
+}
+
+size_t InvertedFile::getListN(const uint32_t id) const{
+  return (termBlocks[id+1] - termBlocks[id]) * BLOCKSIZE + posList[id].size();
+}
+
+PostingCursor InvertedFile::getCursor(const uint32_t id) const{
+  const uint32_t beg = termBlocks[id];
+  return PostingCursor(blockData.begin(), blockOffsets.begin() + beg, blockFront.begin() + beg, 
+		       termBlocks[id+1] - beg, posList[id], 
+		       static_cast<BlockCodec::Method>(cm), BLOCKSIZE);
+}
+
+Minise* InvertedFile::createPart() const{
+  InvertedFile* part = new InvertedFile;
+  part->setParseType(pt);
+  return part;
+}
+
+void InvertedFile::appendPart(Minise& part_){
+  InvertedFile& part(static_cast<InvertedFile&>(part_));
+  const uint32_t offset = static_cast<uint32_t>(text.size());
+
+  // Local termIDs are in order of first appearance in the part,
+  // so assigning global IDs in this order gives the same IDs as serial build.
+  vector<uint32_t> ids(part.posList.size());
+  for (size_t i = 0; i < ids.size(); ++i){
+    if (pt == SEPARATED){
+      ids[i] = getID(part.term2id.getTerm(i), true);
+    } else {
+      ids[i] = getiID(part.iterm2id.getTerm(i), true);
+    }
+  }
+
+  if (termN > posList.size()){
+    posList.resize(termN);
+  }
+
+  // Word ordinals of the part follow those of this index
+  const uint32_t posOffset = (pt == SEPARATED) ? static_cast<uint32_t>(wordOffsets.size()) : offset;
+  for (size_t i = 0; i < ids.size(); ++i){
+    const MappedVector<uint32_t>& v(part.posList[i]);
+    for (size_t j = 0; j < v.size(); ++j){
+      addPosition(ids[i], v[j] + posOffset);
+    }
+  }
+  for (size_t i = 0; i < part.wordOffsets.size(); ++i){
+    wordOffsets.push_back(part.wordOffsets[i] + offset);
+  }
+
+  docLengths.append(part.docLengths.begin(), part.docLengths.end());
+  totalLength += part.totalLength;
+  Minise::appendPart(part);
 }
 
 void InvertedFile::setCompressMethod(const compressMethod& cm_){
   cm = cm_;
 }
 
-void InvertedFile::search(const vector<uint8_t>& query, vector<SeResult>& res) {
+void InvertedFile::setIntersectMethod(const IntersectMethod& im_){
+  im = im_;
+}
+
+void InvertedFile::search(const vector<uint8_t>& query, ResultSet& res, QueryProfile* prof) {
   res.clear();
 
   parseResult parsed;
-  if (parse(query, false, parsed) == -1) return;
+  {
+    ProfileTimer timer(prof, QueryProfile::PARSE);
+    if (parse(query, false, parsed) == -1) return;
+  }
   if (parsed.size() == 0) return;
 
+  if (pt == SEPARATED){
+    // A phrase: the i-th word should be at the ordinal of the first word + i
+    for (size_t i = 0; i < parsed.size(); ++i){
+      parsed[i].second = static_cast<uint32_t>(i);
+    }
+  }
+
   if (pt == C_TWOGRAM){
     // Remove even elements.
     parseResult parsedEven;
     for (size_t i = 0; i < parsed.size(); i += 2){
       parsedEven.push_back(parsed[i]);
     }
+    if (parsed.size() % 2 == 0){
+      parsedEven.push_back(parsed.back()); // The last character
+    }
     parsed.swap(parsedEven);
 
     if (parsed[0].first == NOTFOUND){
-      return searchOneCharacter(query, res); // One character only
+      return searchOneCharacter(query, res, prof); // One character only
     }
   }
 
   vector<pair<size_t, uint32_t> > ord;
   for (size_t i = 0; i < parsed.size(); ++i){
     uint32_t id = parsed[i].first;
-    uint32_t num = posList[id].size() + cPosList[id].size() * BLOCKSIZE;
-    ord.push_back(make_pair(num, i));
+    ord.push_back(make_pair(getListN(id), i));
   }
   sort(ord.begin(), ord.end());
 
   vector<uint32_t> cand;
-  for (size_t i = 0; i < ord.size(); ++i){
-    merge(parsed[ord[i].second], cand);
-    if (cand.size() == 0) return;
+  {
+    ProfileTimer timer(prof, QueryProfile::FETCH);
+    for (size_t i = 0; i < ord.size(); ++i){
+      merge(parsed[ord[i].second], cand, prof);
+      if (prof) prof->addCandidates(i, cand.size());
+      if (cand.size() == 0) return;
+    }
+    if (pt == SEPARATED){
+      for (size_t i = 0; i < cand.size(); ++i){
+	cand[i] = wordOffsets[cand[i]];
+      }
+    }
   }
 
-  decodeDoc(cand, res);
+  decodeDoc(cand, res, prof);
 }
 
-void InvertedFile::searchOneCharacter(const vector<uint8_t>& query, vector<SeResult>& res){
-  uint64_t query_i = 0;
-  for (size_t i = 0; i < query.size(); ++i){
-    query_i <<= 8;
-    query_i += query[i];
+class CompByITerm{
+public:
+  CompByITerm(const TermDic<IntKeys>& dic) : dic(dic) {}
+  bool operator () (const uint32_t id1, const uint32_t id2) const{
+    return dic.getTerm(id1) < dic.getTerm(id2);
+  }
+  bool operator () (const uint32_t id, const uint64_t term) const{
+    return dic.getTerm(id) < term;
   }
-  map<uint64_t, uint32_t>::const_iterator beg = iterm2id.lower_bound(query_i << 32);
+private:
+  const TermDic<IntKeys>& dic;
+};
 
+void InvertedFile::searchOneCharacter(const vector<uint8_t>& query, ResultSet& res, QueryProfile* prof){
   vector<uint32_t> poses;
-  for (map<uint64_t, uint32_t>::const_iterator it = beg;
-       it != iterm2id.end(); ++it){
-    if ((it->first >> 32) > query_i){
-      break;
+  {
+    ProfileTimer timer(prof, QueryProfile::FETCH);
+    uint64_t query_i = 0;
+    for (size_t i = 0; i < query.size(); ++i){
+      query_i <<= 8;
+      query_i += query[i];
     }
-    for (size_t i = 0; i < posList[it->second].size(); ++i){
-      poses.push_back(posList[it->second][i]);
+    const uint32_t* beg = lower_bound(itermOrder.begin(), itermOrder.end(), 
+				      query_i << 32, CompByITerm(iterm2id));
+
+    for (const uint32_t* it = beg; it != itermOrder.end(); ++it){
+      if ((iterm2id.getTerm(*it) >> 32) > query_i){
+        break;
+      }
+      PostingCursor cur(getCursor(*it));
+      cur.setProfile(prof);
+      const uint32_t* p = NULL;
+      size_t len = 0;
+      for (cur.getRun(p, len); len > 0; cur.nextRun(), cur.getRun(p, len)){
+        poses.insert(poses.end(), p, p + len);
+      }
+    }
+    if (prof) prof->addCount(QueryProfile::POSTINGS, poses.size());
+
+    // Offsets of 2-grams are of their second characters
+    const uint32_t len = static_cast<uint32_t>(query.size());
+    for (size_t i = 0; i < poses.size(); ++i){
+      poses[i] -= len;
+    }
+    sort(poses.begin(), poses.end());
+  }
+
+  decodeDoc(poses, res, prof);
+}
+
+size_t InvertedFile::searchOR(const vector<vector<uint8_t> >& terms, const size_t k, 
+			      ResultSet& ret, QueryProfile* prof){
+  if (k == 0) return 0;
+  if (pt != SEPARATED || docN == 0 || boundDocN != docN){
+    return Minise::searchOR(terms, k, ret, prof); // No bounds
+  }
+
+  vector<uint32_t> ids;
+  {
+    ProfileTimer timer(prof, QueryProfile::PARSE);
+    for (size_t t = 0; t < terms.size(); ++t){
+      parseResult parsed;
+      if (parse(terms[t], false, parsed) == -1) continue; // Unknown word
+      if (parsed.size() > 1){
+	return Minise::searchOR(terms, k, ret, prof); // Phrases are not bounded
+      }
+      if (parsed.size() == 1) ids.push_back(parsed[0].first);
     }
   }
+  if (ids.size() == 0) return 0;
+  ProfileTimer timer(prof, QueryProfile::RANK);
+
+  // Terms in ascending order of their maximum scores
+  const size_t m = ids.size();
+  vector<pair<double, uint32_t> > ord;
+  for (size_t t = 0; t < m; ++t){
+    const double idf = bm25IDF(static_cast<double>(termDocN[ids[t]]));
+    ord.push_back(make_pair(idf * termMaxScore[ids[t]], ids[t]));
+  }
+  sort(ord.begin(), ord.end());
+
+  vector<PostingCursor> curs;
+  curs.reserve(m);
+  vector<double> idfs(m);
+  vector<double> prefix(m + 1, 0.0); // prefix[t]: Sum of maximum scores of terms [0, t)
+  vector<uint32_t> docs(m);          // The document at each cursor (docN at the end)
+  for (size_t t = 0; t < m; ++t){
+    const uint32_t id = ord[t].second;
+    curs.push_back(getCursor(id));
+    curs[t].setProfile(prof);
+    idfs[t] = bm25IDF(static_cast<double>(termDocN[id]));
+    prefix[t+1] = prefix[t] + ord[t].first;
+    const uint32_t pos = curs[t].nextGEQ(0);
+    docs[t] = (pos == PostingCursor::END) ? docN : getWordDoc(pos);
+  }
+  const double avgLen = max(getAvgDocLength(), 1.0);
+
+  // MaxScore: terms [0, essential) cannot bring a document into the top k by themselves,
+  // so candidates are enumerated from the other terms only.
+  TopKHeap heap(k);
+  size_t essential = 0;
+  size_t hitN = 0;
+  for (;;){
+    if (heap.full()){
+      while (essential < m && prefix[essential+1] <= heap.threshold()) ++essential;
+    }
+    uint32_t docID = docN;
+    for (size_t t = essential; t < m; ++t){
+      docID = min(docID, docs[t]);
+    }
+    if (docID == docN) break;
+    const uint32_t docEnd = docWords[docID+1];
+
+    if (heap.full()){
+      // Skip the document if the maximum scores of current blocks are not enough
+      double bound = prefix[essential];
+      for (size_t t = essential; t < m; ++t){
+	if (docs[t] != docID) continue;
+	const uint32_t id = ord[t].second;
+	const size_t block = curs[t].getBlock();
+	bound += idfs[t] * ((block < termBlocks[id+1] - termBlocks[id]) ?
+			    blockMaxScore[termBlocks[id] + block] : termMaxScore[id]);
+      }
+      if (bound <= heap.threshold()){
+	for (size_t t = essential; t < m; ++t){
+	  if (docs[t] != docID) continue;
+	  const uint32_t pos = curs[t].nextGEQ(docEnd);
+	  docs[t] = (pos == PostingCursor::END) ? docN : getWordDoc(pos);
+	}
+	continue;
+      }
+    }
 
-  sort(poses.begin(), poses.end());
+    const double docLength = getDocLength(docID);
+    double score = 0.0;
+    bool pruned = false;
+    for (size_t t = m; t-- > 0; ){
+      if (t < essential){
+	if (heap.full() && score + prefix[t+1] <= heap.threshold()){
+	  pruned = true;
+	  break;
+	}
+	if (docs[t] < docID){
+	  const uint32_t pos = curs[t].nextGEQ(docWords[docID]);
+	  docs[t] = (pos == PostingCursor::END) ? docN : getWordDoc(pos);
+	}
+      }
+      if (docs[t] != docID) continue;
+      const size_t tf = curs[t].countLess(docEnd);
+      score += idfs[t] * bm25TF(static_cast<double>(tf), docLength, avgLen);
+      const uint32_t pos = curs[t].nextGEQ(docEnd);
+      docs[t] = (pos == PostingCursor::END) ? docN : getWordDoc(pos);
+    }
+    if (pruned) continue;
+    hitN++;
+    heap.push(score, docID);
+  }
 
-  decodeDoc(poses, res);
+  // Hit positions of top k documents in order of terms in the query
+  vector<pair<double, uint32_t> > top;
+  heap.sorted(top);
+  for (size_t i = 0; i < top.size(); ++i){
+    const uint32_t docID = top[i].second;
+    ret.addDoc(docID);
+    for (size_t t = 0; t < m; ++t){
+      PostingCursor cur(getCursor(ids[t]));
+      const uint32_t* p = NULL;
+      size_t len = 0;
+      if (cur.nextGEQ(docWords[docID]) == PostingCursor::END) continue;
+      for (cur.getRun(p, len); len > 0; cur.nextRun(), cur.getRun(p, len)){
+	size_t j = 0;
+	for (; j < len && p[j] < docWords[docID+1]; ++j){
+	  ret.addOffset(wordOffsets[p[j]] - docOffsets[docID]);
+	}
+	if (j < len) break;
+      }
+    }
+    ret.setScore(i, top[i].first);
+  }
+  return hitN;
 }
 
-void InvertedFile::merge(const pair<uint32_t, uint32_t> qid, vector<uint32_t>& cand){
-  const vector<uint32_t>& v(posList[qid.first]);
-  const vector<CompressedBlock*>& cb(cPosList[qid.first]);
-  const vector<uint32_t>& last(blockFront[qid.first]);
+void InvertedFile::merge(const pair<uint32_t, uint32_t> qid, vector<uint32_t>& cand, QueryProfile* prof){
+  PostingCursor cur(getCursor(qid.first));
+  cur.setProfile(prof);
   const uint32_t offset = qid.second;
+  const uint32_t* p = NULL;
+  size_t len = 0;
   
   if (cand.size() == 0){
-    cand.resize(v.size() + cb.size() * BLOCKSIZE);
-    size_t ind = 0;
-    for (size_t i = 0; i < cb.size(); ++i){
-      cb[i]->decode(buf);
-      copy(buf.begin(), buf.end(), cand.begin() + ind);
-      ind += BLOCKSIZE;
-    }
-    copy(v.begin(), v.end(), cand.begin() + ind);
-    for (size_t i = 0; i < cand.size(); ++i){
-      cand[i] -= offset;
+    // Positions before offset cannot be a part of the query
+    if (cur.nextGEQ(offset) == PostingCursor::END) return;
+    cand.reserve(getListN(qid.first));
+    for (cur.getRun(p, len); len > 0; cur.nextRun(), cur.getRun(p, len)){
+      for (size_t i = 0; i < len; ++i){
+	cand.push_back(p[i] - offset);
+      }
     }
-
+    if (prof) prof->addCount(QueryProfile::POSTINGS, cand.size());
     return;
   }
 
-  // search in compressed blocks
-  vector<uint32_t> nextCand;
+  vector<uint32_t> nextCand(cand.size());
+  size_t n = 0;
   size_t cand_i = 0;
-  for ( ; cand_i < cand.size(); ){
-    vector<uint32_t>::const_iterator it = lower_bound(last.begin(), 
-						      last.end(), 
-						      cand[cand_i] +offset);
-    if (it == last.end()) break;
-    cb[it - last.begin()]->decode(buf);
-
-    size_t buf_ind = 0;
-    while (buf_ind < buf.size()){
-      vector<uint32_t>::const_iterator it = 
-	lower_bound(buf.begin() + buf_ind, buf.end(), cand[cand_i] + offset);
-      if (it == buf.end()) break;
-      if (*it == cand[cand_i] + offset){
-	nextCand.push_back(cand[cand_i]);
-      }
-      buf_ind = it - buf.begin() + 1;
+  size_t postingN = 0; // Positions read from the list
+
+  const size_t listN = getListN(qid.first);
+  if ((im == INTERSECT_AUTO || im == INTERSECT_GALLOP) && 
+      cand.size() * GALLOP_RATIO <= listN){
+    // Few candidates: skip through the list without decoding all touched blocks
+    for ( ; cand_i < cand.size(); ++cand_i){
+      const uint32_t x = cur.nextGEQ(cand[cand_i] + offset);
+      if (x == PostingCursor::END) break;
+      nextCand[n] = cand[cand_i];
+      n += (x == cand[cand_i] + offset);
     }
-    cand_i++;
+    postingN += cand_i;
   }
 
-  size_t ind = 0;
-  for ( ; cand_i < cand.size(); ++cand_i){
-    vector<uint32_t>::const_iterator it = 
-      lower_bound(v.begin() + ind, v.end(), cand[cand_i] + offset);
-    if (it == v.end()) break;
-    if (*it == cand[cand_i] + offset){
-      nextCand.push_back(cand[cand_i]);
-    }
-    ind = it - v.begin();
+  while (cand_i < cand.size()){
+    if (cur.nextGEQ(cand[cand_i] + offset) == PostingCursor::END) break;
+    cur.getRun(p, len);
+
+    // Candidates up to the last position of the run
+    const size_t cand_e = 
+      upper_bound(cand.begin() + cand_i, cand.end(), p[len-1] - offset) - cand.begin();
+    n += intersect(&cand[cand_i], cand_e - cand_i, p, len, offset, &nextCand[n], im);
+    cand_i = cand_e;
+    postingN += len;
+    cur.nextRun();
   }
-  
+  if (prof) prof->addCount(QueryProfile::POSTINGS, postingN);
+
+  nextCand.resize(n);
   cand.swap(nextCand);
 }
 
@@ -235,84 +534,78 @@ int InvertedFile::save(const char* fileName){
   if (write(text,       "text", ofs) == -1) return -1;
   if (write(docOffsets, "docOffset", ofs) == -1) return -1;
   if (write(titles,     "titles", ofs) == -1) return -1;
-  if (write(id2term,    "id2term", ofs) == -1) return -1;
-  if (write(id2iterm,   "id2iterm", ofs) == -1) return -1;
+  if (write(docLengths, "docLengths", ofs) == -1) return -1;
+  if (write(totalLength, "totalLength", ofs) == -1) return -1;
+  if (write(term2id,    "term2id", ofs) == -1) return -1;
+  if (write(iterm2id,   "iterm2id", ofs) == -1) return -1;
+  if (write(itermOrder, "itermOrder", ofs) == -1) return -1;
   if (write(posList,    "posList", ofs) == -1) return -1;
+  if (write(wordOffsets, "wordOffsets", ofs) == -1) return -1;
 
-  if (write(blockFront, "blockFront", ofs) == -1) return -1;
-  uint32_t size = static_cast<uint32_t>(cPosList.size());
-  if (write(size, "cPosList", ofs) == -1) return -1;
-  for (uint32_t i = 0; i < size; ++i){
-    uint32_t ssize = static_cast<uint32_t>(cPosList[i].size());
-    if (write(ssize, "cPosList[i]", ofs) == -1) return -1;
-    for (uint32_t j = 0; j < ssize; ++j){
-      if (cPosList[i][j]->save(ofs) == -1){
-	what_ << "cPosList write error " << i << " " << j;
-	return -1;
-      }
-    }
-  }
+  if (write(blockData,    "blockData", ofs) == -1) return -1;
+  if (write(blockOffsets, "blockOffsets", ofs) == -1) return -1;
+  if (write(blockFront,   "blockFront", ofs) == -1) return -1;
+  if (write(termBlocks,   "termBlocks", ofs) == -1) return -1;
 
-  if (write(cPosList,   "cPosList", ofs) == -1) return -1;
+  if (write(docWords,      "docWords", ofs) == -1) return -1;
+  if (write(termDocN,      "termDocN", ofs) == -1) return -1;
+  if (write(termMaxScore,  "termMaxScore", ofs) == -1) return -1;
+  if (write(blockMaxScore, "blockMaxScore", ofs) == -1) return -1;
+  if (write(boundDocN,     "boundDocN", ofs) == -1) return -1;
 
   return 0;
 }
 
 int InvertedFile::load(const char* fileName){
-  ifstream ifs(fileName);
-  if (!ifs){
+  if (indexFile.open(fileName) == -1){
     what_ << "cannot open " << fileName;
     return -1;
   }
 
   IndexType it = ONEGRAM;
 
-  if (read(it,   "indexType", ifs) == -1) return -1;
-  if (read(pt,   "parseType", ifs) == -1) return -1;
-  if (read(cm,   "compressMethod", ifs) == -1) return -1;
-
-  if (read(text, "text", ifs) == -1) return -1;
-  if (read(docOffsets, "docOffsets", ifs) == -1) return -1;
-  if (read(titles, "titles", ifs) == -1) return -1;
-  if (read(id2term, "id2term", ifs) == -1) return -1;
-  if (read(id2iterm, "id2iterm", ifs) == -1) return -1;
-  if (read(posList, "posList", ifs) == -1) return -1;
-
-  if (read(blockFront, "blockFront", ifs) == -1) return -1;
-
-
-  uint32_t size = 0;
-  if (read(size, "cPosList", ifs) == -1) return -1;
-  cPosList.resize(size);
-  for (uint32_t i = 0; i < size; ++i){
-    uint32_t ssize = 0;
-    if (read(ssize, "cPosList", ifs) == -1) return -1;
-    cPosList[i].resize(ssize);
-    for (uint32_t j = 0; j < ssize; ++j){
-      if (cm == VARBYTE){
-	cPosList[i][j] = new VarByte;
-      } else if (cm == RICECODE){
-	cPosList[i][j] = new RiceCode;
-      } else {
-	what_ << "Unkwnon Compress Method";
-	return -1;
-      }
-      if (cPosList[i][j]->load(ifs) == -1){
-	what_ << "cPosList read error " << i << " " << j;
-	return -1;
-      }
-    }
+  if (read(it,   "indexType", indexFile) == -1) return -1;
+  if (read(pt,   "parseType", indexFile) == -1) return -1;
+  if (read(cm,   "compressMethod", indexFile) == -1) return -1;
+
+  if (read(text, "text", indexFile) == -1) return -1;
+  if (read(docOffsets, "docOffsets", indexFile) == -1) return -1;
+  if (read(titles, "titles", indexFile) == -1) return -1;
+  if (read(docLengths, "docLengths", indexFile) == -1) return -1;
+  if (read(totalLength, "totalLength", indexFile) == -1) return -1;
+  if (read(term2id, "term2id", indexFile) == -1) return -1;
+  if (read(iterm2id, "iterm2id", indexFile) == -1) return -1;
+  if (read(itermOrder, "itermOrder", indexFile) == -1) return -1;
+  if (read(posList, "posList", indexFile) == -1) return -1;
+  if (read(wordOffsets, "wordOffsets", indexFile) == -1) return -1;
+
+  if (read(blockData, "blockData", indexFile) == -1) return -1;
+  if (read(blockOffsets, "blockOffsets", indexFile) == -1) return -1;
+  if (read(blockFront, "blockFront", indexFile) == -1) return -1;
+  if (read(termBlocks, "termBlocks", indexFile) == -1) return -1;
+
+  if (read(docWords, "docWords", indexFile) == -1) return -1;
+  if (read(termDocN, "termDocN", indexFile) == -1) return -1;
+  if (read(termMaxScore, "termMaxScore", indexFile) == -1) return -1;
+  if (read(blockMaxScore, "blockMaxScore", indexFile) == -1) return -1;
+  if (read(boundDocN, "boundDocN", indexFile) == -1) return -1;
+  if (cm != NONE && cm != VARBYTE && cm != RICECODE && cm != BINARYPACKING && 
+      cm != STREAMVBYTE && cm != ELIASFANO){
+    what_ << "Unkwnon Compress Method";
+    return -1;
   }
 
-  assert(posList.size() == cPosList.size());
-  assert(posList.size() == blockFront.size());
-
-  for (size_t i = 0; i < id2term.size(); ++i){
-    term2id[id2term[i]] = static_cast<uint32_t>(i);
+  if (termBlocks.size() != posList.size() + 1){
+    what_ << "broken index: termBlocks:" << termBlocks.size() << " posList:" << posList.size();
+    return -1;
   }
-
-  for (size_t i = 0; i < id2iterm.size(); ++i){
-    iterm2id[id2iterm[i]] = static_cast<uint32_t>(i);
+  if (blockOffsets.size() != (blockFront.empty() ? 0 : blockFront.size() + 1)){
+    what_ << "broken index: blockOffsets:" << blockOffsets.size() << " blockFront:" << blockFront.size();
+    return -1;
+  }
+  if (!blockOffsets.empty() && blockOffsets.back() != blockData.size()){
+    what_ << "broken index: blockOffsets end:" << blockOffsets.back() << " blockData:" << blockData.size();
+    return -1;
   }
 
   docN = static_cast<uint32_t>(docOffsets.size())-1;
@@ -321,9 +614,95 @@ int InvertedFile::load(const char* fileName){
 }
 
 int InvertedFile::build() {
+  if (checkTextSize32() == -1) return -1;
+  term2id.freeze();
+  iterm2id.freeze();
+  sortBlocks();
+  if (pt == SEPARATED){
+    buildBounds();
+  }
+
+  itermOrder.clear();
+  if (pt == C_TWOGRAM){
+    for (uint32_t i = 0; i < iterm2id.size(); ++i){
+      itermOrder.push_back(i);
+    }
+    uint32_t* order = itermOrder.writable();
+    sort(order, order + itermOrder.size(), CompByITerm(iterm2id));
+  }
   return 0;
 }
 
+namespace {
+
+/// A float not less than x
+float upperFloat(const double x){
+  return static_cast<float>(x * (1.0 + 1e-6)); // Rounding a double to a float loses less than 1e-7
+}
+
+}
+
+void InvertedFile::buildBounds(){
+  vector<uint32_t> newDocWords(1, 0);
+  newDocWords.reserve(docN + 1);
+  for (uint32_t docID = 0; docID < docN; ++docID){
+    newDocWords.push_back(newDocWords.back() + docLengths[docID] + 1); // Words and the guard
+  }
+  assert(newDocWords.back() == wordOffsets.size());
+  docWords.swap(newDocWords);
+
+  const double avgLen = max(getAvgDocLength(), 1.0);
+  vector<uint32_t> newTermDocN(termN);
+  vector<float> newTermMax(termN);
+  vector<float> newBlockMax(blockFront.size());
+  vector<uint32_t> docIDs;
+  vector<float> weights;
+  for (uint32_t id = 0; id < termN; ++id){
+    docIDs.clear();
+    weights.clear();
+    PostingCursor cur(getCursor(id));
+    for (uint32_t pos = cur.nextGEQ(0); pos != PostingCursor::END; ){
+      const uint32_t docID = getWordDoc(pos);
+      const size_t tf = cur.countLess(docWords[docID+1]);
+      docIDs.push_back(docID);
+      weights.push_back(upperFloat(bm25TF(static_cast<double>(tf), getDocLength(docID), avgLen)));
+      pos = cur.nextGEQ(docWords[docID+1]);
+    }
+    newTermDocN[id] = static_cast<uint32_t>(docIDs.size());
+    newTermMax[id] = weights.empty() ? 0.f : *max_element(weights.begin(), weights.end());
+
+    // Documents in a block are up to the document of its last position,
+    // and the last document may continue to the next block.
+    size_t j = 0;
+    for (uint32_t block = termBlocks[id]; block < termBlocks[id+1]; ++block){
+      const uint32_t last = getWordDoc(blockFront[block]);
+      float w = 0.f;
+      for (; j < docIDs.size() && docIDs[j] <= last; ++j){
+	w = max(w, weights[j]);
+      }
+      newBlockMax[block] = w;
+      if (j > 0 && docIDs[j-1] == last) --j;
+    }
+  }
+  termDocN.swap(newTermDocN);
+  termMaxScore.swap(newTermMax);
+  blockMaxScore.swap(newBlockMax);
+  boundDocN = docN;
+}
+
+uint32_t InvertedFile::getWordDoc(const uint32_t ord) const{
+  return static_cast<uint32_t>(upper_bound(docWords.begin(), docWords.end(), ord) - docWords.begin()) - 1;
+}
+
+uint32_t InvertedFile::getDocLength(const uint32_t docID) const{
+  return docLengths[docID];
+}
+
+double InvertedFile::getAvgDocLength() const{
+  if (docN == 0) return 0.0;
+  return static_cast<double>(totalLength) / docN;
+}
+
 string InvertedFile::getIndexName() const{
   string name = "";
   if (pt == C_ONEGRAM) {
@@ -341,6 +720,12 @@ string InvertedFile::getIndexName() const{
     name += " VarByte";
   } else if (cm == RICECODE){
     name += " RiceCode";
+  } else if (cm == BINARYPACKING){
+    name += " BinaryPacking";
+  } else if (cm == STREAMVBYTE){
+    name += " StreamVByte";
+  } else if (cm == ELIASFANO){
+    name += " EliasFano";
   } else {
     name += " Unknown";
   }
@@ -349,13 +734,20 @@ string InvertedFile::getIndexName() const{
 
 size_t InvertedFile::getIndexSize() const {
   size_t ret = Minise::getIndexSize(); // Calculate Basic Class Size()
+  ret += itermOrder.size() * sizeof(uint32_t);
+  ret += docLengths.size() * sizeof(uint32_t);
+  ret += wordOffsets.size() * sizeof(uint32_t);
   for (size_t i = 0; i < posList.size(); ++i){
     ret += posList[i].size() * sizeof(uint32_t);
-    ret += blockFront[i].size() * sizeof(uint32_t);
-    for (size_t j = 0; j < cPosList[i].size(); ++j){
-      ret += cPosList[i][j]->size();
-    }
   }
+  ret += blockData.size();
+  ret += blockOffsets.size() * sizeof(uint64_t);
+  ret += blockFront.size() * sizeof(uint32_t);
+  ret += termBlocks.size() * sizeof(uint32_t);
+  ret += docWords.size() * sizeof(uint32_t);
+  ret += termDocN.size() * sizeof(uint32_t);
+  ret += termMaxScore.size() * sizeof(float);
+  ret += blockMaxScore.size() * sizeof(float);
   return ret;
 }
 
@@ -28,14 +28,16 @@
 #define INVERTED_FILE_HPP__
 
 #include "miniseBase.hpp"
-#include "varByte.hpp"
-#include "riceCode.hpp"
+#include "blockCodec.hpp"
+#include "intersect.hpp"
+#include "postingCursor.hpp"
 
 namespace SE{
 
 /**
  * Inverted File Index.
- * Also support 1/2-gram index
+ * Also support 1/2-gram index.
+ * Word positions are ordinals, so that a query of several words is a phrase
  */
 
 class InvertedFile : public Minise {
@@ -44,9 +46,12 @@ class InvertedFile : public Minise {
   };
 public:
   enum compressMethod {
-    NONE = 0,
-    VARBYTE = 1,
-    RICECODE = 2
+    NONE = BlockCodec::NONE,
+    VARBYTE = BlockCodec::VARBYTE,
+    RICECODE = BlockCodec::RICECODE,
+    BINARYPACKING = BlockCodec::BINARYPACKING,
+    STREAMVBYTE = BlockCodec::STREAMVBYTE,
+    ELIASFANO = BlockCodec::ELIASFANO
   };
 
   InvertedFile(); ///< Constructor
@@ -55,25 +60,58 @@ public:
   int save(const char* fileName); ///< Save the index to file
   int load(const char* fileName); ///< Load the index from file
 
-  int build();
+  int build(); ///< Freeze the term dictionaries and group compressed blocks by terms
   size_t getIndexSize() const;
+  uint32_t getDocLength(const uint32_t docID) const; ///< The number of terms in the document
+  double getAvgDocLength() const;
   void setCompressMethod(const compressMethod& cm_);
+  void setIntersectMethod(const IntersectMethod& im_); ///< Kernel to intersect posting lists (not saved)
   std::string getIndexName() const;
 
 private:
-  void search(const std::vector<uint8_t>& query, std::vector<SeResult>& ret); ///< Search the document for the query
-  void searchOneCharacter(const std::vector<uint8_t>& query, std::vector<SeResult>& ret);
+  void search(const std::vector<uint8_t>& query, ResultSet& ret, QueryProfile* prof); ///< Search the document for the query
+  void searchOneCharacter(const std::vector<uint8_t>& query, ResultSet& ret, QueryProfile* prof);
 
-  void merge(const std::pair<uint32_t, uint32_t> qid, std::vector<uint32_t>& cand);
+  size_t searchOR(const std::vector<std::vector<uint8_t> >& terms, const size_t k, 
+		  ResultSet& ret, QueryProfile* prof); ///< MaxScore with block-max bounds for words
+  void merge(const std::pair<uint32_t, uint32_t> qid, std::vector<uint32_t>& cand, QueryProfile* prof);
   void addIndex(const std::vector<uint8_t>& content);
+  void addPosition(const uint32_t id, const uint32_t pos);
+  void sortBlocks();
+  void buildBounds();
+  uint32_t getWordDoc(const uint32_t ord) const; ///< The document of a word ordinal
+  size_t getListN(const uint32_t id) const;
+  PostingCursor getCursor(const uint32_t id) const;
+  Minise* createPart() const;
+  void appendPart(Minise& part);
 
-  std::vector<std::vector<uint32_t> > posList;
-  std::vector<std::vector<CompressedBlock*>  > cPosList;
-  std::vector<std::vector<uint32_t> > blockFront;
+  std::vector<MappedVector<uint32_t> > posList; ///< Positions not compressed yet
 
-  std::vector<uint32_t> buf;
+  // Compressed blocks of all terms are stored in one arena.
+  // Blocks of the term id are [termBlocks[id], termBlocks[id+1]) after build().
+  MappedVector<uint8_t>  blockData;    ///< Compressed blocks
+  MappedVector<uint64_t> blockOffsets; ///< Byte offset of each block in blockData (blockN+1)
+  MappedVector<uint32_t> blockFront;   ///< The last position of each block
+  MappedVector<uint32_t> termBlocks;   ///< The first block of each term (termN+1)
+  std::vector<uint32_t>  blockTerms;   ///< The term of each block added after build()
+
+  MappedVector<uint32_t> docLengths; ///< The number of terms in each document
+  uint64_t totalLength;              ///< The number of terms in all documents
+  MappedVector<uint32_t> itermOrder; ///< utf8term IDs sorted by utf8terms (2-gram only)
+  MappedVector<uint32_t> wordOffsets; ///< Text position of each word ordinal (SEPARATED only)
+
+  // BM25 weights without IDF are bounded for OR queries of words by build().
+  MappedVector<uint32_t> docWords;      ///< The first word ordinal of each document (docN+1)
+  MappedVector<uint32_t> termDocN;      ///< The number of documents containing each term
+  MappedVector<float>    termMaxScore;  ///< The maximum weight of each term
+  MappedVector<float>    blockMaxScore; ///< The maximum weight of documents in each block
+  uint32_t boundDocN;                   ///< docN when the bounds are built
+
+  std::vector<uint32_t> buf; ///< Working area to compress a block
+  std::vector<uint8_t> code; ///< Working area to compress a block
 
   compressMethod cm;
+  IntersectMethod im;
 };
 
 }
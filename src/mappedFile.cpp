@@ -0,0 +1,91 @@
+/*
+ * mappedFile.cpp
+ * Copyright (c) 2009 Daisuke Okanohara All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "mappedFile.hpp"
+
+using namespace std;
+
+namespace SE{
+
+MappedFile::MappedFile() : addr(NULL), fileSize(0), cur(0) {
+}
+
+MappedFile::~MappedFile(){
+  close();
+}
+
+int MappedFile::open(const char* fileName){
+  close();
+  int fd = ::open(fileName, O_RDONLY);
+  if (fd == -1){
+    return -1;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) == -1){
+    ::close(fd);
+    return -1;
+  }
+  fileSize = static_cast<size_t>(st.st_size);
+  if (fileSize == 0){
+    ::close(fd);
+    return 0;
+  }
+
+  void* p = mmap(NULL, fileSize, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd); // The mapping remains after close
+  if (p == MAP_FAILED){
+    fileSize = 0;
+    return -1;
+  }
+  addr = static_cast<uint8_t*>(p);
+  return 0;
+}
+
+void MappedFile::close(){
+  if (addr != NULL){
+    munmap(addr, fileSize);
+  }
+  addr = NULL;
+  fileSize = 0;
+  cur = 0;
+}
+
+const uint8_t* MappedFile::get(const size_t size, const size_t align){
+  size_t beg = (cur + align - 1) / align * align;
+  if (beg > fileSize || size > fileSize - beg){
+    return NULL;
+  }
+  cur = beg + size;
+  return addr + beg;
+}
+
+}
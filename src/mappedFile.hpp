@@ -0,0 +1,87 @@
+/*
+ * mappedFile.hpp
+ * Copyright (c) 2009 Daisuke Okanohara All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef MAPPED_FILE_HPP__
+#define MAPPED_FILE_HPP__
+
+#include <cstddef>
+#include <stdint.h>
+
+namespace SE{
+
+/**
+ * Read-only memory mapped file.
+ * An index file is mapped as a whole, and its arrays are used in place
+ * through MappedVector. Regions are taken from the head of the file in order.
+ */
+class MappedFile {
+public:
+  enum {
+    ALIGNMENT = 8 ///< Arrays in an index file begin at multiples of ALIGNMENT
+  };
+
+  MappedFile();  ///< Constructor
+  ~MappedFile(); ///< Destructor (unmap the file)
+
+  /**
+   * Map the file
+   * @param fileName A file name to be mapped
+   * @return Return 0 if it succeded or -1 if failed
+   */
+  int open(const char* fileName);
+
+  /**
+   * Unmap the file
+   */
+  void close();
+
+  /**
+   * Take the next region of the file
+   * @param size A size of the region in bytes
+   * @param align The region begins at a multiple of align
+   * @return The beginning of the region or NULL if the file is too short
+   */
+  const uint8_t* get(const size_t size, const size_t align);
+
+  /**
+   * @return The number of bytes which are not read yet
+   */
+  size_t remain() const {
+    return fileSize - cur;
+  }
+
+private:
+  MappedFile(const MappedFile&);
+  MappedFile& operator=(const MappedFile&);
+
+  uint8_t* addr;   ///< The beginning of the mapping
+  size_t fileSize; ///< A size of the mapped file
+  size_t cur;      ///< A current read position
+};
+
+}
+
+#endif // MAPPED_FILE_HPP__
@@ -0,0 +1,203 @@
+/*
+ * mappedVector.hpp
+ * Copyright (c) 2009 Daisuke Okanohara All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef MAPPED_VECTOR_HPP__
+#define MAPPED_VECTOR_HPP__
+
+#include <vector>
+#include <algorithm>
+#include <fstream>
+#include <cstddef>
+#include <cstring>
+#include <stdint.h>
+#include "mappedFile.hpp"
+
+namespace SE{
+
+/**
+ * Array which either owns its elements (at index building)
+ * or refers to a region of a MappedFile (after loading).
+ * Elements are read only through const accessors, and modified through
+ * writable(), which copies the elements of a referring array first,
+ * since the mapping is read-only.
+ * In a file, an array is its size (uint64_t) followed by its elements
+ * from the next multiple of MappedFile::ALIGNMENT.
+ */
+template<class T> class MappedVector {
+public:
+  typedef T value_type;
+  typedef T* iterator;
+  typedef const T* const_iterator;
+
+  MappedVector() : ptr(NULL), n(0), mapped(false) {}
+
+  MappedVector(const MappedVector& mv) : own(mv.own), ptr(mv.ptr), n(mv.n), mapped(mv.mapped) {
+    if (!mapped) sync();
+  }
+
+  MappedVector& operator=(const MappedVector& mv){
+    if (this != &mv){
+      own    = mv.own;
+      ptr    = mv.ptr;
+      n      = mv.n;
+      mapped = mv.mapped;
+      if (!mapped) sync();
+    }
+    return *this;
+  }
+
+  /**
+   * Refer to the region instead of owning elements
+   * @param p The beginning of the region
+   * @param size The number of elements in the region
+   */
+  void map(const T* p, const size_t size){
+    std::vector<T>().swap(own);
+    ptr    = const_cast<T*>(p);
+    n      = size;
+    mapped = true;
+  }
+
+  bool isMapped() const { return mapped; }
+
+  size_t size() const { return n; }
+  bool empty() const { return n == 0; }
+
+  const T& operator[](const size_t i) const { return ptr[i]; }
+
+  const_iterator begin() const { return ptr; }
+  const_iterator end() const { return ptr + n; }
+
+  const T& front() const { return ptr[0]; }
+  const T& back() const { return ptr[n-1]; }
+
+  /**
+   * Own the elements, copying them from the mapped region if referring
+   * @return The elements to be modified
+   */
+  iterator writable(){
+    unmap();
+    return ptr;
+  }
+
+  void push_back(const T& v){
+    unmap();
+    own.push_back(v);
+    sync();
+  }
+
+  template<class It> void append(It first, It last){
+    unmap();
+    own.insert(own.end(), first, last);
+    sync();
+  }
+
+  void resize(const size_t size, const T& v = T()){
+    unmap();
+    own.resize(size, v);
+    sync();
+  }
+
+  void reserve(const size_t size){
+    unmap();
+    own.reserve(size);
+    sync();
+  }
+
+  void clear(){
+    own.clear();
+    ptr    = NULL;
+    n      = 0;
+    mapped = false;
+  }
+
+  void swap(MappedVector& mv){
+    own.swap(mv.own);
+    std::swap(ptr, mv.ptr);
+    std::swap(n, mv.n);
+    std::swap(mapped, mv.mapped);
+  }
+
+  void swap(std::vector<T>& v){
+    unmap();
+    own.swap(v);
+    sync();
+  }
+
+  /**
+   * Write the array so that load() can map it
+   * @return Return 0 if it succeded or -1 if failed
+   */
+  int save(std::ofstream& ofs) const{
+    const uint64_t size = n; // Arrays may be over 4 GB
+    if (!ofs.write((const char*)(&size), sizeof(size))) return -1;
+    for (size_t pos = static_cast<size_t>(ofs.tellp()); pos % MappedFile::ALIGNMENT != 0; ++pos){
+      if (!ofs.put(0)) return -1; // Align for mapping
+    }
+    if (size == 0) return 0;
+    if (!ofs.write((const char*)(ptr), sizeof(T) * size)) return -1;
+    return 0;
+  }
+
+  /**
+   * Refer to the array written by save() in the mapped file
+   * @return Return 0 if it succeded or -1 if failed
+   */
+  int load(MappedFile& mf){
+    uint64_t size = 0;
+    const uint8_t* p = mf.get(sizeof(size), 1);
+    if (p == NULL) return -1;
+    memcpy(&size, p, sizeof(size));
+    // A broken or foreign header must not wrap sizeof(T) * size around
+    if (size > (static_cast<size_t>(-1) - MappedFile::ALIGNMENT) / sizeof(T)) return -1;
+    p = mf.get(sizeof(T) * size, MappedFile::ALIGNMENT);
+    if (p == NULL) return -1;
+    map(reinterpret_cast<const T*>(p), size);
+    return 0;
+  }
+
+private:
+  void sync(){
+    ptr = own.empty() ? NULL : &own[0];
+    n   = own.size();
+  }
+
+  void unmap(){
+    if (!mapped) return;
+    own.assign(ptr, ptr + n); // Copy on modification
+    mapped = false;
+    sync();
+  }
+
+  std::vector<T> own; ///< Elements owned by this array
+  T* ptr;             ///< The beginning of elements
+  size_t n;           ///< The number of elements
+  bool mapped;        ///< Refer to a mapped region or not
+};
+
+}
+
+#endif // MAPPED_VECTOR_HPP__
@@ -30,7 +30,9 @@
 #include "miniseBase.hpp"
 #include "invertedFile.hpp"
 #include "suffixArray.hpp"
+#include "fmIndex.hpp"
 #include "quickSearch.hpp"
+#include "shardedMinise.hpp"
 
 #endif // MINISE_HPP__
 
@@ -25,15 +25,23 @@
  */
 
 #include <stdio.h>
+#include <math.h>
 #include <algorithm>
-#include <sstream>
+#include <cctype>
+#include <cstring>
 #include "miniseBase.hpp"
+#include "parallel.hpp"
+#include "topKHeap.hpp"
 
 using namespace std;
 
 namespace SE{
 
-SeResult::SeResult(string& title, uint32_t docID, vector<uint32_t>& offsets) :  title(title), docID(docID), offsets(offsets)
+SeResult::SeResult() : docID(0), score(0.0)
+{
+}
+
+SeResult::SeResult(string& title, uint32_t docID, vector<uint32_t>& offsets) :  title(title), docID(docID), offsets(offsets), score(0.0)
 {
 }
 
@@ -72,80 +80,399 @@ void Minise::addDoc(const char* title, const vector<uint8_t>& content){
   titles.push_back(title);
 
   addIndex(content);
-  for (size_t i = 0; i < content.size(); ++i){
-    text.push_back(content[i]);
-  }
+  text.append(content.begin(), content.end());
   text.push_back(0); // Guard
-  docOffsets.push_back(static_cast<uint32_t>(text.size()));
+  docOffsets.push_back(text.size());
   
   docN++;
 }
 
 
+namespace {
+
+class AddFilesTask : public ParallelTask {
+public:
+  AddFilesTask(const vector<string>& fileNames, vector<Minise*>& parts) :
+    fileNames(fileNames), parts(parts), failed(parts.size(), 0) {}
+
+  void run(const int threadID){
+    const size_t beg = fileNames.size() * threadID / parts.size();
+    const size_t end = fileNames.size() * (threadID + 1) / parts.size();
+    for (size_t i = beg; i < end; ++i){
+      if (parts[threadID]->addFile(fileNames[i].c_str()) == -1){
+	failed[threadID] = 1;
+	return;
+      }
+    }
+  }
+
+  bool isFailed(const size_t threadID) const {
+    return failed[threadID] != 0;
+  }
+
+private:
+  const vector<string>& fileNames;
+  vector<Minise*>& parts;
+  vector<char> failed; ///< vector<bool> is not safe for concurrent writes
+};
+
+}
+
+int Minise::addFiles(const vector<string>& fileNames, const int threadN){
+  if (threadN <= 1){
+    for (size_t i = 0; i < fileNames.size(); ++i){
+      if (addFile(fileNames[i].c_str()) == -1) return -1;
+    }
+    return 0;
+  }
+
+  vector<Minise*> parts(threadN);
+  for (int i = 0; i < threadN; ++i){
+    parts[i] = createPart();
+  }
+
+  AddFilesTask task(fileNames, parts);
+  int ret = runParallel(task, threadN);
+  if (ret == -1){
+    what_ << "cannot create threads";
+  }
+
+  for (int i = 0; i < threadN; ++i){
+    if (ret == 0 && task.isFailed(i)){
+      what_ << parts[i]->what();
+      ret = -1;
+    }
+    if (ret == 0){
+      appendPart(*parts[i]);
+    }
+    delete parts[i];
+  }
+  return ret;
+}
+
+void Minise::appendPart(Minise& part){
+  const uint64_t offset = text.size();
+  titles.insert(titles.end(), part.titles.begin(), part.titles.end());
+  text.append(part.text.begin(), part.text.end());
+  for (size_t i = 1; i < part.docOffsets.size(); ++i){
+    docOffsets.push_back(part.docOffsets[i] + offset);
+  }
+  docN += part.docN;
+}
+
 uint32_t Minise::getID(const string& str, const bool modify){
-  map<string, uint32_t>::const_iterator it = term2id.find(str);
-  if (it != term2id.end()){
-    return it->second;
+  uint32_t id = term2id.find(str);
+  if (id != TermDic<StringKeys>::EMPTY){
+    return id;
   } else if (modify){
-    id2term.push_back(str);
-    return term2id[str] = termN++;
+    termN++;
+    return term2id.add(str);
   } else {
     return NOTFOUND;
   }
 }
 
 uint32_t Minise::getiID(const uint64_t str, const bool modify){
-  map<uint64_t, uint32_t>::const_iterator it = iterm2id.find(str);
-  if (it != iterm2id.end()){
-    return it->second;
+  uint32_t id = iterm2id.find(str);
+  if (id != TermDic<IntKeys>::EMPTY){
+    return id;
   } else if (modify){
-    id2iterm.push_back(str);
-    return iterm2id[str] = termN++;
+    termN++;
+    return iterm2id.add(str);
   } else {
     return NOTFOUND;
   }
 }
 
+size_t Minise::searchTerms(const char* query, const size_t len, vector<ResultSet>& rets, 
+			   QueryProfile* prof){
+  if (len == 0) return 0;
+  vector<vector<uint8_t> > vqueries;
+  {
+    ProfileTimer timer(prof, QueryProfile::PARSE);
+    splitQuery(query, len, vqueries);
+  }
+
+  searchTerms(vqueries, rets, prof);
+  return vqueries.size();
+}
+
+void Minise::searchTerms(const vector<vector<uint8_t> >& terms, vector<ResultSet>& rets, 
+			 QueryProfile* prof){
+  if (rets.size() < terms.size()) rets.resize(terms.size());
+  for (size_t i = 0; i < terms.size(); ++i){
+    search(terms[i], rets[i], prof);
+  }
+}
+
+void Minise::splitQuery(const char* query, const size_t len, vector<vector<uint8_t> >& terms){
+  terms.clear();
+  // Terms are separated by spaces, and "..." is one term including spaces (a phrase)
+  for (size_t i = 0; i < len; ){
+    if (isspace(static_cast<unsigned char>(query[i]))){
+      ++i;
+      continue;
+    }
+    size_t b = i;
+    size_t e = i;
+    if (query[i] == '"'){
+      b = i + 1;
+      const char* q = static_cast<const char*>(memchr(query + b, '"', len - b));
+      e = q ? static_cast<size_t>(q - query) : len;
+      i = q ? e + 1 : len;
+    } else {
+      while (e < len && !isspace(static_cast<unsigned char>(query[e]))) ++e;
+      i = e;
+    }
+    if (b < e){
+      terms.push_back(vector<uint8_t>(query + b, query + e));
+    }
+  }
+}
+
 void Minise::search(const char* query, const size_t len, vector<SeResult>& ret){
+  ResultSet rs;
+  search(query, len, rs);
+  rs.rankByTF();
+  toSeResults(rs, ret);
+}
+
+void Minise::search(const char* query, const size_t len, ResultSet& ret, QueryProfile* prof){
+  SearchContext ctx;
+  search(query, len, ret, ctx, prof);
+}
+
+void Minise::search(const char* query, const size_t len, ResultSet& ret, SearchContext& ctx, 
+		    QueryProfile* prof){
+  const size_t n = searchTerms(query, len, ctx.rets, prof);
+  ProfileTimer timer(prof, QueryProfile::SEARCH_AND);
+  searchAND(ctx.rets, n, ret, ctx.next);
+}
+
+void Minise::listDocs(const char* query, const size_t len, vector<uint32_t>& docIDs, 
+		      vector<uint32_t>* counts, QueryProfile* prof){
+  docIDs.clear();
+  if (counts) counts->clear();
+  vector<vector<uint8_t> > terms;
+  {
+    ProfileTimer timer(prof, QueryProfile::PARSE);
+    splitQuery(query, len, terms);
+  }
+
+  vector<uint32_t> termDocIDs;
+  vector<uint32_t> termCounts;
+  for (size_t t = 0; t < terms.size(); ++t){
+    if (t == 0){
+      listDocs(terms[t], docIDs, counts, prof);
+      continue;
+    }
+    if (docIDs.empty()) break;
+    termDocIDs.clear();
+    termCounts.clear();
+    listDocs(terms[t], termDocIDs, counts ? &termCounts : NULL, prof);
+
+    // Keep documents of all terms in place, summing up their counts
+    ProfileTimer timer(prof, QueryProfile::SEARCH_AND);
+    size_t hitN = 0;
+    size_t ind = 0;
+    for (size_t i = 0; i < docIDs.size(); ++i){
+      ind = lower_bound(termDocIDs.begin() + ind, termDocIDs.end(), docIDs[i]) - termDocIDs.begin();
+      if (ind == termDocIDs.size()) break;
+      if (termDocIDs[ind] != docIDs[i]) continue;
+      docIDs[hitN] = docIDs[i];
+      if (counts) (*counts)[hitN] = (*counts)[i] + termCounts[ind];
+      ++hitN;
+    }
+    docIDs.resize(hitN);
+    if (counts) counts->resize(hitN);
+  }
+}
+
+void Minise::listDocs(const vector<uint8_t>& query, vector<uint32_t>& docIDs, 
+		      vector<uint32_t>* counts, QueryProfile* prof){
+  ResultSet rs;
+  search(query, rs, prof);
+  for (size_t i = 0; i < rs.size(); ++i){
+    docIDs.push_back(rs.getDocID(i));
+    if (counts) counts->push_back(static_cast<uint32_t>(rs.getOffsetN(i)));
+  }
+}
+
+void Minise::toSeResults(const ResultSet& rs, vector<SeResult>& ret) const{
+  ret.resize(rs.size());
+  for (size_t i = 0; i < rs.size(); ++i){
+    SeResult& r(ret[i]);
+    r.docID = rs.getDocID(i);
+    r.title = getTitle(r.docID);
+    r.offsets.assign(rs.getOffsets(i), rs.getOffsets(i) + rs.getOffsetN(i));
+    r.score = rs.getScore(i);
+  }
+}
+
+namespace {
+
+const double BM25_K1 = 1.2;
+const double BM25_B  = 0.75;
+
+}
+
+size_t Minise::searchTopK(const char* query, const size_t len, const size_t k, vector<SeResult>& ret){
+  ResultSet rs;
+  const size_t hitN = searchTopK(query, len, k, rs);
+  toSeResults(rs, ret);
+  return hitN;
+}
+
+size_t Minise::searchTopK(const char* query, const size_t len, const size_t k, ResultSet& ret, 
+			  QueryProfile* prof){
   ret.clear();
-  if (len == 0) return;
-  string query_s(query);
-  istringstream is(query_s);
-  vector< vector<SeResult> > origRets;
-  string querySingle;
-
-  while (is >> querySingle){
-    vector<uint8_t> vquery;
-    for (size_t i = 0; i < querySingle.size(); ++i){
-      vquery.push_back(static_cast<uint8_t>(querySingle[i]));
+  if (k == 0) return 0;
+  vector<ResultSet> rets;
+  const size_t m = searchTerms(query, len, rets, prof);
+  if (m == 0) return 0;
+  ProfileTimer timer(prof, QueryProfile::RANK); // Intersection and scoring
+
+  // Candidates are enumerated from the term with the fewest hit documents
+  vector<pair<size_t, size_t> > ord;
+  for (size_t i = 0; i < m; ++i){
+    ord.push_back(make_pair(rets[i].size(), i));
+  }
+  sort(ord.begin(), ord.end());
+
+  vector<double> idfs(m);
+  for (size_t t = 0; t < m; ++t){
+    idfs[t] = bm25IDF(static_cast<double>(rets[ord[t].second].size()));
+  }
+  const double avgLen = max(getAvgDocLength(), 1.0);
+
+  TopKHeap heap(k);
+  vector<size_t> beg(m, 0);
+  size_t hitN = 0;
+  const ResultSet& first(rets[ord[0].second]);
+  for (size_t j = 0; j < first.size(); ++j){
+    const uint32_t docID = first.getDocID(j);
+    size_t t = 1;
+    for (; t < m; ++t){
+      const ResultSet& r(rets[ord[t].second]);
+      beg[t] = r.lowerBound(docID, beg[t]);
+      if (beg[t] == r.size() || r.getDocID(beg[t]) != docID) break;
+    }
+    if (t < m){
+      if (beg[t] == rets[ord[t].second].size()) break; // No more hits
+      continue;
+    }
+    hitN++;
+
+    const double docLength = getDocLength(docID);
+    double score = idfs[0] * bm25TF(static_cast<double>(first.getOffsetN(j)), docLength, avgLen);
+    for (size_t t = 1; t < m; ++t){
+      const double tf = static_cast<double>(rets[ord[t].second].getOffsetN(beg[t]));
+      score += idfs[t] * bm25TF(tf, docLength, avgLen);
+    }
+    heap.push(score, docID);
+  }
+
+  // Hit positions are found again only for the top k documents
+  vector<pair<double, uint32_t> > top;
+  heap.sorted(top);
+  for (size_t i = 0; i < top.size(); ++i){
+    const uint32_t docID = top[i].second;
+    ret.addDoc(docID);
+    for (size_t t = 0; t < m; ++t){
+      const ResultSet& r(rets[ord[t].second]);
+      const size_t pos = r.lowerBound(docID, 0);
+      ret.addOffsets(r.getOffsets(pos), r.getOffsets(pos) + r.getOffsetN(pos));
     }
-    vector<SeResult> retSingle;
-    search(vquery, retSingle);
-    origRets.push_back(retSingle);
+    ret.setScore(i, top[i].first);
   }
+  return hitN;
+}
 
-  searchAND(origRets, ret);
-  rankByTF(ret);
-  return ;
+size_t Minise::searchTopKOR(const char* query, const size_t len, const size_t k, vector<SeResult>& ret){
+  ResultSet rs;
+  const size_t hitN = searchTopKOR(query, len, k, rs);
+  toSeResults(rs, ret);
+  return hitN;
+}
 
-  while (is >> querySingle){
-    vector<uint8_t> vquery;
-    for (size_t i = 0; i < querySingle.size(); ++i){
-      vquery.push_back(static_cast<uint8_t>(querySingle[i]));
+size_t Minise::searchTopKOR(const char* query, const size_t len, const size_t k, ResultSet& ret, 
+			    QueryProfile* prof){
+  ret.clear();
+  if (k == 0) return 0;
+  vector<vector<uint8_t> > terms;
+  {
+    ProfileTimer timer(prof, QueryProfile::PARSE);
+    splitQuery(query, len, terms);
+  }
+  if (terms.size() == 0) return 0;
+  return searchOR(terms, k, ret, prof);
+}
+
+size_t Minise::searchOR(const vector<vector<uint8_t> >& terms, const size_t k, 
+			ResultSet& ret, QueryProfile* prof){
+  if (k == 0) return 0;
+  const size_t m = terms.size();
+  vector<ResultSet> rets;
+  searchTerms(terms, rets, prof);
+  ProfileTimer timer(prof, QueryProfile::RANK); // Union and scoring
+
+  vector<double> idfs(m);
+  for (size_t t = 0; t < m; ++t){
+    idfs[t] = bm25IDF(static_cast<double>(rets[t].size()));
+  }
+  const double avgLen = max(getAvgDocLength(), 1.0);
+
+  // Every document in the union of hit documents is scored
+  TopKHeap heap(k);
+  vector<size_t> cur(m, 0);
+  size_t hitN = 0;
+  for (;;){
+    uint32_t docID = NOTFOUND;
+    for (size_t t = 0; t < m; ++t){
+      if (cur[t] < rets[t].size()) docID = min(docID, rets[t].getDocID(cur[t]));
     }
-    vector<SeResult> retSingle;
-    search(vquery, retSingle);
-    origRets.push_back(retSingle);
+    if (docID == NOTFOUND) break;
+
+    const double docLength = getDocLength(docID);
+    double score = 0.0;
+    for (size_t t = 0; t < m; ++t){
+      if (cur[t] == rets[t].size() || rets[t].getDocID(cur[t]) != docID) continue;
+      score += idfs[t] * bm25TF(static_cast<double>(rets[t].getOffsetN(cur[t])), docLength, avgLen);
+      ++cur[t];
+    }
+    hitN++;
+    heap.push(score, docID);
+  }
+
+  vector<pair<double, uint32_t> > top;
+  heap.sorted(top);
+  for (size_t i = 0; i < top.size(); ++i){
+    const uint32_t docID = top[i].second;
+    ret.addDoc(docID);
+    for (size_t t = 0; t < m; ++t){
+      const size_t j = rets[t].lowerBound(docID, 0);
+      if (j == rets[t].size() || rets[t].getDocID(j) != docID) continue;
+      ret.addOffsets(rets[t].getOffsets(j), rets[t].getOffsets(j) + rets[t].getOffsetN(j));
+    }
+    ret.setScore(i, top[i].first);
   }
+  return hitN;
+}
+
+double Minise::bm25IDF(const double df) const{
+  return log(1.0 + (docN - df + 0.5) / (df + 0.5));
+}
 
-  searchAND(origRets, ret);
-  rankByTF(ret);
+double Minise::bm25TF(const double tf, const double docLength, const double avgLength){
+  return tf * (BM25_K1 + 1.0) / (tf + BM25_K1 * (1.0 - BM25_B + BM25_B * docLength / avgLength));
 }
 
-void Minise::searchAND(vector<vector<SeResult> >& origRets, vector<SeResult>& andRet){
-  if (origRets.size() == 0) return;
+void Minise::searchAND(vector<ResultSet>& origRets, const size_t n, 
+		       ResultSet& andRet, ResultSet& next){
+  andRet.clear();
+  if (n == 0) return;
   vector<pair<size_t, size_t> > ord;
-  for (size_t i = 0; i < origRets.size(); ++i){
+  for (size_t i = 0; i < n; ++i){
     ord.push_back(make_pair(origRets[i].size(), i));
   }
 
@@ -153,67 +480,86 @@ void Minise::searchAND(vector<vector<SeResult> >& origRets, vector<SeResult>& an
   andRet.swap(origRets[ord[0].second]);
 
   for (size_t i = 1; i < ord.size(); ++i){
-    vector<SeResult>& ret(origRets[ord[i].second]);
-    vector<SeResult> next;
+    const ResultSet& ret(origRets[ord[i].second]);
+    next.clear();
     size_t ind = 0;
     for (size_t j = 0; j < andRet.size(); ++j){
-      uint32_t docID = andRet[j].docID;
-      
-      vector<SeResult>::const_iterator it = 
-	lower_bound(ret.begin() + ind, ret.end(), docID);
-      if (it == ret.end()) break;
-      if (it->docID == docID){
-	SeResult r(andRet[j].title, docID, andRet[j].offsets);
-	for (size_t k = 0; k < it->offsets.size(); ++k){
-	  r.offsets.push_back(it->offsets[k]);
-	}
-	next.push_back(r);
+      const uint32_t docID = andRet.getDocID(j);
+      ind = ret.lowerBound(docID, ind);
+      if (ind == ret.size()) break;
+      if (ret.getDocID(ind) == docID){
+	next.addDoc(andRet, j, docID);
+	next.addOffsets(ret.getOffsets(ind), ret.getOffsets(ind) + ret.getOffsetN(ind));
       }
     }
     andRet.swap(next);
   }
 }
 
-class CompByTF{
-public:
-  int operator () (const SeResult& sr1, const SeResult& sr2) const{
-    return sr1.offsets.size() < sr2.offsets.size();
-  }
-};
-
-void Minise::rankByTF(vector<SeResult>& ret){
-  sort(ret.rbegin(), ret.rend(), CompByTF());
-}
-
 void Minise::getSnippet(const uint32_t docID, const int offset, const uint32_t len, string& ret) const{
-  const uint32_t beg = docOffsets[docID] + offset;
-  const uint32_t end = std::min(beg + len, docOffsets[docID+1]); // [docN] = test.size()
+  const uint64_t beg = docOffsets[docID] + offset;
+  const uint64_t end = std::min(beg + len, docOffsets[docID+1]); // [docN] = test.size()
   
   for (size_t i = beg; i < end; ++i){
     ret.push_back(text[i]);
   }
 }
 
-void Minise::decodeDoc(const vector<uint32_t>& cand, vector<SeResult>& res){
-  if (cand.size() == 0) return;
-  
+const string& Minise::getTitle(const uint32_t docID) const{
+  return titles[docID];
+}
+
+uint32_t Minise::getDocLength(const uint32_t docID) const{
+  return static_cast<uint32_t>(docOffsets[docID+1] - docOffsets[docID] - 1); // Exclude the guard
+}
+
+double Minise::getAvgDocLength() const{
+  if (docN == 0) return 0.0;
+  return static_cast<double>(text.size() - docN) / docN;
+}
+
+namespace {
+
+template<class Pos>
+void decodePositions(const vector<Pos>& cand, const MappedVector<uint64_t>& docOffsets, ResultSet& res){
   uint32_t begDocID = 0;
   for (size_t i = 0; i < cand.size(); ){
-    vector<uint32_t>::const_iterator it = 
-      upper_bound(docOffsets.begin() + begDocID, docOffsets.end(), cand[i]);
-    uint32_t cur_offset = *(it-1);
-    uint32_t next_offset = *it;
-    vector<uint32_t> offsets;
+    const uint64_t* it = 
+      upper_bound(docOffsets.begin() + begDocID, docOffsets.end(), static_cast<uint64_t>(cand[i]));
+    uint64_t cur_offset = *(it-1);
+    uint64_t next_offset = *it;
+    uint32_t docID = it - docOffsets.begin() - 1;
+    res.addDoc(docID);
     while (i < cand.size() && cand[i] < next_offset ){
-      offsets.push_back(cand[i] - cur_offset);
+      res.addOffset(static_cast<uint32_t>(cand[i] - cur_offset)); // Offsets in a document fit in 32 bits
       ++i;
     }
-    uint32_t docID = it - docOffsets.begin() - 1;
-    res.push_back(SeResult(titles[docID], docID, offsets));
     begDocID = docID + 1;
   }
 }
 
+}
+
+void Minise::decodeDoc(const vector<uint32_t>& cand, ResultSet& res, QueryProfile* prof){
+  if (cand.size() == 0) return;
+  ProfileTimer timer(prof, QueryProfile::DECODE_DOC);
+  decodePositions(cand, docOffsets, res);
+}
+
+void Minise::decodeDoc(const vector<uint64_t>& cand, ResultSet& res, QueryProfile* prof){
+  if (cand.size() == 0) return;
+  ProfileTimer timer(prof, QueryProfile::DECODE_DOC);
+  decodePositions(cand, docOffsets, res);
+}
+
+int Minise::checkTextSize32(){
+  if (text.size() > 0xFFFFFFFFULL){
+    what_ << getIndexName() << " cannot index a text over 4 GB (use sa or shards) : " << text.size();
+    return -1;
+  }
+  return 0;
+}
+
 
 string Minise::what() const {
   return what_.str();
@@ -240,24 +586,25 @@ int Minise::write(const vector<string>& vs, const char* vnmae, ofstream& ofs){
   return 0;
 }
 
-int Minise::read(vector<string>& vs, const char* vname, ifstream& ifs){
+int Minise::read(vector<string>& vs, const char* vname, MappedFile& mf){
   uint32_t size = 0;
-  if (read(size, "string::size", ifs) == -1){
+  if (read(size, "string::size", mf) == -1){
     return -1;
   }
 
   vs.resize(size);
   for (size_t i = 0; i < vs.size(); ++i){
     uint32_t ssize = 0;
-    if (read(ssize, "strig::size", ifs) == -1){
+    if (read(ssize, "strig::size", mf) == -1){
       return -1;
     }
 
-    vs[i].resize(ssize);
-    if (!ifs.read((char*)(&vs[i][0]), sizeof(char) * ssize)){
+    const uint8_t* p = mf.get(sizeof(char) * ssize, 1);
+    if (p == NULL){
       what_ << "vector::string::read error";
       return -1;
     }
+    vs[i].assign((const char*)p, ssize);
   }
   return 0;
 }
@@ -266,17 +613,14 @@ size_t Minise::getIndexSize() const {
   size_t ret = 0;
   ret += text.size() * sizeof(uint8_t);
   
-  for (size_t i = 0; i < id2term.size(); ++i){
-    ret += id2term[i].size();
-  }
-
-  ret += sizeof(uint32_t) * id2iterm.size();
+  ret += term2id.byteSize();
+  ret += iterm2id.byteSize();
 
   for (size_t i = 0; i < titles.size(); ++i){
     ret += titles[i].size();
   }
 
-  ret += docOffsets.size() * sizeof(uint32_t);
+  ret += docOffsets.size() * sizeof(uint64_t);
   return ret;
 }
 
@@ -329,6 +673,13 @@ int Minise::parseUTF8(const vector<uint8_t>& buf, const bool modify, parseResult
     len = 1;
   }
 
+  if (pt == C_TWOGRAM && modify && prev != NOTFOUND){
+    // Index the last character followed by NUL, so that one character queries find it.
+    // As other 2-grams, the offset is of the second character.
+    const uint32_t id = getiID((uint64_t)prev << 32, modify);
+    parsed.push_back(make_pair(id, static_cast<uint32_t>(buf.size())));
+  }
+
   if (pt == C_TWOGRAM && 
       parsed.size() == 0 &&
       prev != NOTFOUND){
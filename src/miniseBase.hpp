@@ -30,10 +30,15 @@
 #include <vector>
 #include <string>
 #include <sstream>
-#include <map>
 #include <fstream>
+#include <cstring>
 #include <stdint.h>
 #include "varByte.hpp"
+#include "mappedFile.hpp"
+#include "mappedVector.hpp"
+#include "termDic.hpp"
+#include "resultSet.hpp"
+#include "queryProfile.hpp"
 
 namespace SE{
 
@@ -48,14 +53,28 @@ struct SeResult{
   std::string title;      ///< A title of a hit document
   uint32_t docID;         ///< A document ID in Minise
   std::vector<uint32_t> offsets;  ///< Hit positions offsets;
+  double score;           ///< A ranking score (only by searchTopK)
 
   bool operator < (const int val) const{
     return (int)docID < val;
   }
 };
 
+/**
+ * Buffers reused by search() across queries.
+ * Results of terms and the intersection in progress keep their memory,
+ * so a caller searching many queries with one context does not reallocate.
+ * A context must not be shared by threads searching at the same time.
+ */
+struct SearchContext{
+  std::vector<ResultSet> rets; ///< Results for terms (grown, never shrunk)
+  ResultSet next;              ///< An intersection in progress
+};
+
 /**
  * Base class for search engines.
+ * search() and searchTopK() do not modify a built or loaded index,
+ * so they can be called from several threads at once.
  */
 class Minise{
 public:
@@ -68,7 +87,9 @@ public:
     TWOGRAM = 2,         ///< Character 2-gram
     INVERTEDFILE = 3,    ///< Inverted File
     SUFFIXARRAY = 4,     ///< Suffix Array
-    SUFFIXARRAY_UTF8 = 5 ///< Suffix Array for UTF-8
+    SUFFIXARRAY_UTF8 = 5, ///< Suffix Array for UTF-8
+    SHARDED = 6,         ///< Documents are partitioned into several indexes
+    FMINDEX = 7          ///< FM-index
   };
 
   /**
@@ -103,16 +124,113 @@ public:
    * @param title A title of the document 
    * @param content A data of the document (UTF-8)
    */ 
-  void addDoc(const char* title, const std::vector<uint8_t>& content);
+  virtual void addDoc(const char* title, const std::vector<uint8_t>& content);
+
+  /**
+   * Register files using multiple threads.
+   * Files are split into threadN ranges which are indexed into partial indexes
+   * in parallel, and then the partial indexes are appended in order.
+   * The result is the same as calling addFile for each file.
+   * @param fileNames File names to be registered
+   * @param threadN The number of threads
+   * @return Return 0 if it succeded or -1 if failed
+   */
+  virtual int addFiles(const std::vector<std::string>& fileNames, const int threadN);
 
   /**
    * Full-text search for a query using an index.
    * @param query A query 
    * @param len A length of the query
-   * @param ret A search result
+   * @param ret A search result ranked by term-frequency
    */
   void search(const char* query, const size_t len, std::vector<SeResult>& ret);
 
+  /**
+   * Full-text search for a query without copying titles.
+   * Use ResultSet::rankByTF() to rank the result.
+   * @param query A query 
+   * @param len A length of the query
+   * @param ret A search result in order of docIDs
+   * @param prof Stage durations and counters are added if given
+   */
+  void search(const char* query, const size_t len, ResultSet& ret, QueryProfile* prof = NULL);
+
+  /**
+   * Full-text search for a query reusing the buffers of previous queries.
+   * @param query A query 
+   * @param len A length of the query
+   * @param ret A search result in order of docIDs
+   * @param ctx Buffers owned by the caller
+   * @param prof Stage durations and counters are added if given
+   */
+  void search(const char* query, const size_t len, ResultSet& ret, SearchContext& ctx, 
+	      QueryProfile* prof = NULL);
+
+  /**
+   * Full-text search ranked by BM25. Only the top k documents are materialized.
+   * @param query A query 
+   * @param len A length of the query
+   * @param k The number of documents to be returned
+   * @param ret Top k documents in descending order of scores
+   * @return The number of hit documents
+   */
+  size_t searchTopK(const char* query, const size_t len, const size_t k, std::vector<SeResult>& ret);
+
+  /**
+   * Full-text search ranked by BM25 without copying titles.
+   * @param query A query 
+   * @param len A length of the query
+   * @param k The number of documents to be returned
+   * @param ret Top k documents with scores in descending order of scores
+   * @param prof Stage durations and counters are added if given
+   * @return The number of hit documents
+   */
+  size_t searchTopK(const char* query, const size_t len, const size_t k, ResultSet& ret, 
+		    QueryProfile* prof = NULL);
+
+  /**
+   * Disjunctive (OR) search ranked by BM25. Documents containing any term are ranked.
+   * @param query A query 
+   * @param len A length of the query
+   * @param k The number of documents to be returned
+   * @param ret Top k documents in descending order of scores
+   * @return The number of scored documents (documents which cannot be
+   *         in the top k may be skipped without scoring)
+   */
+  size_t searchTopKOR(const char* query, const size_t len, const size_t k, std::vector<SeResult>& ret);
+
+  /**
+   * Disjunctive (OR) search ranked by BM25 without copying titles.
+   * @param query A query 
+   * @param len A length of the query
+   * @param k The number of documents to be returned
+   * @param ret Top k documents with scores in descending order of scores
+   * @param prof Stage durations and counters are added if given
+   * @return The number of scored documents
+   */
+  size_t searchTopKOR(const char* query, const size_t len, const size_t k, ResultSet& ret, 
+		      QueryProfile* prof = NULL);
+
+  /**
+   * List the documents containing all terms of a query without their positions.
+   * Documents of a term are found in time proportional to their number
+   * rather than to its occurrences if the index supports it (sa with a document list).
+   * @param query A query 
+   * @param len A length of the query
+   * @param docIDs Hit documents in increasing order
+   * @param counts The number of occurrences of terms in each hit document if given
+   * @param prof Stage durations and counters are added if given
+   */
+  void listDocs(const char* query, const size_t len, std::vector<uint32_t>& docIDs, 
+		std::vector<uint32_t>* counts = NULL, QueryProfile* prof = NULL);
+
+  /**
+   * Convert a compact result into SeResults with titles
+   * @param rs A compact result
+   * @param ret Converted result
+   */
+  void toSeResults(const ResultSet& rs, std::vector<SeResult>& ret) const;
+
   /**
    * Save the current index to disk
    * @param fileName An index file name
@@ -153,8 +271,26 @@ public:
    * @param offset A position in the document
    * @param len A length of a snipet
    */
-  void getSnippet(const uint32_t docID, const int offset, 
-		 const uint32_t len, std::string& ret) const;
+  virtual void getSnippet(const uint32_t docID, const int offset, 
+			  const uint32_t len, std::string& ret) const;
+
+  /**
+   * @param docID document ID
+   * @return A title of the document
+   */
+  virtual const std::string& getTitle(const uint32_t docID) const;
+
+  /**
+   * Return the length of a document used for BM25 (bytes by default)
+   * @param docID document ID
+   * @return A length of the document
+   */
+  virtual uint32_t getDocLength(const uint32_t docID) const;
+
+  /**
+   * @return The average length of documents
+   */
+  virtual double getAvgDocLength() const;
 
   /**
    * Return the index type name (may not equal to class name)
@@ -185,23 +321,87 @@ protected:
    * Full-text search for a query using an index
    * @param query A query 
    * @param ret A search result
+   * @param prof Stage durations and counters are added if not NULL
    */
-  virtual void search(const std::vector<uint8_t>& query, std::vector<SeResult>& ret) = 0;
+  virtual void search(const std::vector<uint8_t>& query, ResultSet& ret, QueryProfile* prof) = 0;
 
 
 
   /**
-   * Compute AND result
-   * @param rets Results for single queries
-   * @param andRet Result for AND query
+   * List the documents containing a term. The default collects documents of search().
+   * @param query A term
+   * @param docIDs Hit documents in increasing order
+   * @param counts The number of occurrences in each hit document if not NULL
+   * @param prof Stage durations and counters are added if not NULL
    */
-  static void searchAND(std::vector<std::vector<SeResult> >& rets, std::vector<SeResult>& andRet);
+  virtual void listDocs(const std::vector<uint8_t>& query, std::vector<uint32_t>& docIDs, 
+			std::vector<uint32_t>* counts, QueryProfile* prof);
 
   /**
-   * Sort results by term-frequency
-   * @param ret Sort Result
+   * Search each space separated term in a query
+   * @param query A query 
+   * @param len A length of the query
+   * @param rets Results for terms in rets[0...n) (grown if smaller)
+   * @param prof A profile or NULL
+   * @return The number of terms n
    */
-  static void rankByTF(std::vector<SeResult>& ret);
+  size_t searchTerms(const char* query, const size_t len, std::vector<ResultSet>& rets, 
+		   QueryProfile* prof);
+
+  /**
+   * Search each term. The default calls search() for each term.
+   * @param terms Terms in a query
+   * @param rets Results for terms in rets[0...terms.size()) (grown if smaller).
+   *             Results beyond them are left for later queries.
+   * @param prof A profile or NULL
+   */
+  virtual void searchTerms(const std::vector<std::vector<uint8_t> >& terms, 
+			   std::vector<ResultSet>& rets, QueryProfile* prof);
+
+  /**
+   * Split a query into space separated terms. "..." is one term including spaces.
+   * @param query A query 
+   * @param len A length of the query
+   * @param terms Terms in the query
+   */
+  static void splitQuery(const char* query, const size_t len, 
+			 std::vector<std::vector<uint8_t> >& terms);
+
+  /**
+   * Top k documents containing any of terms by BM25.
+   * Every document hit by some term is scored by default.
+   * @param terms Terms in a query
+   * @param k The number of documents to be returned
+   * @param ret Top k documents with scores in descending order of scores
+   * @param prof A profile or NULL
+   * @return The number of scored documents
+   */
+  virtual size_t searchOR(const std::vector<std::vector<uint8_t> >& terms, const size_t k, 
+			  ResultSet& ret, QueryProfile* prof);
+
+  /**
+   * @param df The number of documents containing a term
+   * @return BM25 IDF of the term
+   */
+  double bm25IDF(const double df) const;
+
+  /**
+   * @param tf The number of occurrences of a term in a document
+   * @param docLength The length of the document
+   * @param avgLength The average length of documents
+   * @return BM25 weight of the term in the document without IDF
+   */
+  static double bm25TF(const double tf, const double docLength, const double avgLength);
+
+  /**
+   * Compute AND result. The buffers of rets, andRet and next are exchanged by swap.
+   * @param rets Results for single queries in rets[0...n)
+   * @param n The number of single queries
+   * @param andRet Result for AND query
+   * @param next A buffer for intermediate results
+   */
+  static void searchAND(std::vector<ResultSet>& rets, const size_t n, 
+			ResultSet& andRet, ResultSet& next);
 
   /**
    * Assign ID to Term
@@ -225,12 +425,39 @@ protected:
    */
   virtual void addIndex(const std::vector<uint8_t>& content) = 0;
 
+  /**
+   * Create an empty index with the same settings for addFiles.
+   * A partial index keeps its postings uncompressed.
+   * @return A new partial index
+   */
+  virtual Minise* createPart() const = 0;
+
+  /**
+   * Append documents of a partial index created by createPart.
+   * DocIDs, text positions and termIDs of the part are remapped.
+   * @param part A partial index
+   */
+  virtual void appendPart(Minise& part);
+
   /**
    * Convert Global Positions into docs and offsets
    * @param cand Global Positions
    * @param ret Converted result
+   * @param prof A profile or NULL
+   */
+  void decodeDoc(const std::vector<uint32_t>& cand, ResultSet& ret, QueryProfile* prof);
+
+  /**
+   * Convert Global Positions of a text over 4 GB into docs and offsets
+   * @see decodeDoc(const std::vector<uint32_t>&, ResultSet&, QueryProfile*)
    */
-  void decodeDoc(const std::vector<uint32_t>& cand, std::vector<SeResult>& ret);
+  void decodeDoc(const std::vector<uint64_t>& cand, ResultSet& ret, QueryProfile* prof);
+
+  /**
+   * Check that positions in the text fit in 32 bits, for indexes storing 32-bit positions
+   * @return Return 0 if they fit or -1 if not
+   */
+  int checkTextSize32();
 
   /**
    * Parse the input and extract terms
@@ -260,7 +487,7 @@ protected:
   int parseSeparated(const std::vector<uint8_t>& buf, const bool modify, parseResult& parsed);
 
   int write(const std::vector<std::string>& vs, const char* vname, std::ofstream& ofs);
-  int read(std::vector<std::string>& vs, const char* vname, std::ifstream& ifs);
+  int read(std::vector<std::string>& vs, const char* vname, MappedFile& mf);
 
   template<class T> int write(const std::vector<T>& v, const char* vname, std::ofstream& ofs){
     uint32_t size = static_cast<uint32_t>(v.size());
@@ -274,6 +501,14 @@ protected:
     return 0;
   }
 
+  template<class T> int write(const MappedVector<T>& v, const char* vname, std::ofstream& ofs){
+    if (v.save(ofs) == -1){
+      what_ << "write error:" << vname;
+      return -1;
+    }
+    return 0;
+  }
+
   template<class T> int write(const T v, const char* vname, std::ofstream& ofs){
     if (!ofs.write((const char*)(&v), sizeof(T))){
       what_ << "write error:" << vname;
@@ -282,36 +517,84 @@ protected:
     return 0;
   }
 
-  template<class T> int read(std::vector<T>& v, const char* vname, std::ifstream& ifs){
+  template<class Keys> int write(const TermDic<Keys>& dic, const char* vname, std::ofstream& ofs){
+    if (write(dic.keys, vname, ofs) == -1) return -1;
+    if (write(dic.table, vname, ofs) == -1) return -1;
+    return 0;
+  }
+
+  int write(const StringKeys& keys, const char* vname, std::ofstream& ofs){
+    if (write(keys.chars, vname, ofs) == -1) return -1;
+    if (write(keys.offsets, vname, ofs) == -1) return -1;
+    return 0;
+  }
+
+  int write(const IntKeys& keys, const char* vname, std::ofstream& ofs){
+    return write(keys.keys, vname, ofs);
+  }
+
+  template<class T> int read(std::vector<T>& v, const char* vname, MappedFile& mf){
     uint32_t size = 0;
-    if (read(size, vname, ifs) == -1) return -1;
+    if (read(size, vname, mf) == -1) return -1;
 
     if (size == 0) return 0;
     v.resize(size);
     for (size_t i = 0; i < size; ++i){
-      if (read(v[i], vname, ifs) == -1){
+      if (read(v[i], vname, mf) == -1){
 	return -1;
       }
     }
     return 0;
   }
 
-  template<class T> int read(T& v, const char* vname, std::ifstream& ifs){
-    if (!ifs.read((char*)(&v), sizeof(T))){
+  /**
+   * Refer to the array in the mapped index instead of copying it
+   */
+  template<class T> int read(MappedVector<T>& v, const char* vname, MappedFile& mf){
+    if (v.load(mf) == -1){
+      what_ << "read error:" << vname;
+      return -1;
+    }
+    return 0;
+  }
+
+  /**
+   * Use the frozen dictionary in the mapped index
+   */
+  template<class Keys> int read(TermDic<Keys>& dic, const char* vname, MappedFile& mf){
+    dic.clear();
+    if (read(dic.keys, vname, mf) == -1) return -1;
+    if (read(dic.table, vname, mf) == -1) return -1;
+    return 0;
+  }
+
+  int read(StringKeys& keys, const char* vname, MappedFile& mf){
+    if (read(keys.chars, vname, mf) == -1) return -1;
+    if (read(keys.offsets, vname, mf) == -1) return -1;
+    return 0;
+  }
+
+  int read(IntKeys& keys, const char* vname, MappedFile& mf){
+    return read(keys.keys, vname, mf);
+  }
+
+  template<class T> int read(T& v, const char* vname, MappedFile& mf){
+    const uint8_t* p = mf.get(sizeof(T), 1);
+    if (p == NULL){
       what_ << "read error:" << vname;
       return -1;
     }
+    memcpy(&v, p, sizeof(T));
     return 0;
   }
 
 protected:
-  std::vector<uint8_t> text;               ///< A concatenated text for registered documents.
-  std::map<std::string, uint32_t> term2id; ///< A mapping from term to ID
-  std::vector<std::string> id2term;        ///< A mapping from ID to term
-  std::map<uint64_t, uint32_t> iterm2id; ///< A mapping from utf8term to ID
-  std::vector<uint64_t> id2iterm;        ///< A mapping from ID to utf8term
+  MappedFile indexFile;                    ///< A mapped index file (after load)
+  MappedVector<uint8_t> text;              ///< A concatenated text for registered documents.
+  TermDic<StringKeys> term2id;             ///< A mapping between term and ID
+  TermDic<IntKeys> iterm2id;               ///< A mapping between utf8term and ID
   std::vector<std::string> titles;         ///< Titles of registered documents.OA
-  std::vector<uint32_t> docOffsets;        ///< Beginning positions of documents in text
+  MappedVector<uint64_t> docOffsets;       ///< Beginning positions of documents in text
   uint32_t docN;                           ///< Number of documents
   uint32_t termN;                          ///< Number of (appeared) terms
 
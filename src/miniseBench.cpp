@@ -0,0 +1,538 @@
+/*
+ * miniseBench.cpp
+ * Copyright (c) 2009 Daisuke Okanohara All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include "minise.hpp"
+#include "cmdline.h"
+#include "timer.hpp"
+
+using namespace std;
+using namespace SE;
+using namespace cmdline;
+
+/*
+ * Builds every index method with every codec on synthetic corpora,
+ * runs fixed query mixes and prints one tab separated row for each
+ * (corpus, method, codec, mix). Each engine runs in a child process
+ * so that its peak RSS is measured separately.
+ * Engines matching substrings (seq, 1gram, 2gram, sa, sa8, fm) are checked
+ * against seq, and inverted files (inv) are checked against inv/none.
+ */
+
+const char* mixNames[] = {"1term", "2terms", "3terms"};
+const size_t mixN = 3;
+
+/// Deterministic pseudo random numbers
+class XorShift{
+public:
+  XorShift(const uint32_t seed) : x(123456789 ^ seed) {
+    if (x == 0) x = 123456789;
+  }
+  uint32_t next(){
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return x;
+  }
+  /// Rank in [0, n) with probability about 1/(rank+1)
+  size_t zipf(const size_t n){
+    const double u = (next() & 0xFFFFFF) / static_cast<double>(0x1000000);
+    const size_t r = static_cast<size_t>(exp(u * log(static_cast<double>(n))));
+    return min(r, n) - 1;
+  }
+private:
+  uint32_t x;
+};
+
+struct Corpus{
+  string name;
+  size_t docN;
+  size_t docLen;
+  vector<string> docs;
+  vector<vector<string> > queries; ///< queries[mix]
+};
+
+void appendUTF8(const uint32_t c, string& s){
+  if (c < 0x80){
+    s += static_cast<char>(c);
+  } else if (c < 0x800){
+    s += static_cast<char>(0xC0 | (c >> 6));
+    s += static_cast<char>(0x80 | (c & 0x3F));
+  } else {
+    s += static_cast<char>(0xE0 | (c >> 12));
+    s += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+    s += static_cast<char>(0x80 | (c & 0x3F));
+  }
+}
+
+/// Words of lower case letters (ascii), or Hiragana and Kanji (ja)
+void genVocab(XorShift& rnd, const string& name, const size_t vocabN, vector<string>& vocab){
+  vocab.resize(vocabN);
+  for (size_t i = 0; i < vocabN; ++i){
+    string& w(vocab[i]);
+    if (name == "ascii"){
+      const size_t len = 2 + rnd.next() % 7;
+      for (size_t j = 0; j < len; ++j){
+	w += static_cast<char>('a' + rnd.next() % 26);
+      }
+    } else {
+      const size_t len = 1 + rnd.next() % 4;
+      for (size_t j = 0; j < len; ++j){
+	if (rnd.next() % 10 < 7){
+	  appendUTF8(0x3041 + rnd.next() % 83, w);  // Hiragana
+	} else {
+	  appendUTF8(0x4E00 + rnd.next() % 1000, w); // Kanji
+	}
+      }
+    }
+  }
+}
+
+void genCorpus(const string& name, const size_t docN, const size_t docLen, 
+	       const size_t queryN, const uint32_t seed, Corpus& corpus){
+  XorShift rnd(seed);
+  corpus.name   = name;
+  corpus.docN   = docN;
+  corpus.docLen = docLen;
+
+  vector<string> vocab;
+  genVocab(rnd, name, 5000, vocab);
+  const bool ascii = (name == "ascii");
+  corpus.docs.resize(docN);
+  for (size_t i = 0; i < docN; ++i){
+    string& doc(corpus.docs[i]);
+    for (size_t w = 1; doc.size() < docLen; ++w){
+      doc += vocab[rnd.zipf(vocab.size())];
+      if (w % 12 == 0){
+	doc += ascii ? ".\n" : "\xE3\x80\x82\n"; // "。"
+      } else if (ascii){
+	doc += ' ';
+      }
+    }
+  }
+
+  corpus.queries.assign(mixN, vector<string>(queryN));
+  for (size_t m = 0; m < mixN; ++m){
+    for (size_t q = 0; q < queryN; ++q){
+      string& query(corpus.queries[m][q]);
+      for (size_t t = 0; t <= m; ++t){
+	if (t > 0) query += ' ';
+	query += vocab[rnd.zipf(vocab.size())];
+      }
+    }
+  }
+}
+
+Minise* initMinise(const string& method, const string& cm_s){
+  InvertedFile::compressMethod cm = InvertedFile::NONE;
+  if (cm_s == "none"){
+    cm = InvertedFile::NONE;
+  } else if (cm_s == "vb"){
+    cm = InvertedFile::VARBYTE;
+  } else if (cm_s == "rc"){
+    cm = InvertedFile::RICECODE;
+  } else if (cm_s == "bp"){
+    cm = InvertedFile::BINARYPACKING;
+  } else if (cm_s == "svb"){
+    cm = InvertedFile::STREAMVBYTE;
+  } else if (cm_s == "ef"){
+    cm = InvertedFile::ELIASFANO;
+  } else {
+    return NULL;
+  }
+
+  Minise* ms = NULL;
+  if (method == "inv" || method == "1gram" || method == "2gram"){
+    ms = new InvertedFile;
+    if (method == "inv"){
+      ms->setParseType(Minise::SEPARATED);
+    } else if (method == "1gram"){
+      ms->setParseType(Minise::C_ONEGRAM);
+    } else {
+      ms->setParseType(Minise::C_TWOGRAM);
+    }
+    static_cast<InvertedFile*>(ms)->setCompressMethod(cm);
+  } else if (cm != InvertedFile::NONE){
+    return NULL; // Codecs are only for inverted files
+  } else if (method == "seq") {
+    ms = new QuickSearch;
+  } else if (method == "sa"){
+    ms = new SuffixArray;
+  } else if (method == "sa8"){
+    ms = new SuffixArray;
+    static_cast<SuffixArray*>(ms)->setUTF8();
+  } else if (method == "fm"){
+    ms = new FMIndex;
+  }
+  return ms;
+}
+
+Minise* newMinise(const Minise::IndexType indexType){
+  if (indexType == Minise::QUICKSEARCH){
+    return new QuickSearch;
+  } else if (indexType == Minise::ONEGRAM ||
+	     indexType == Minise::TWOGRAM ||
+	     indexType == Minise::INVERTEDFILE){
+    return new InvertedFile;
+  } else if (indexType == Minise::SUFFIXARRAY ||
+	     indexType == Minise::SUFFIXARRAY_UTF8){
+    return new SuffixArray;
+  } else if (indexType == Minise::FMINDEX){
+    return new FMIndex;
+  } else if (indexType == Minise::SHARDED){
+    return new ShardedMinise;
+  }
+  return NULL;
+}
+
+/// Resident set size in kilo bytes
+long getRSS(){
+  ifstream ifs("/proc/self/status");
+  string line;
+  while (getline(ifs, line)){
+    if (line.compare(0, 6, "VmRSS:") == 0){
+      return atol(line.c_str() + 6);
+    }
+  }
+  return -1;
+}
+
+/// FNV-1a hash of hit documents and positions
+uint64_t digest(const ResultSet& ret){
+  uint64_t h = 14695981039346656037ULL;
+  for (size_t i = 0; i < ret.size(); ++i){
+    uint32_t vals[2] = {ret.getDocID(i), static_cast<uint32_t>(ret.getOffsetN(i))};
+    for (size_t v = 0; v < 2; ++v){
+      h = (h ^ vals[v]) * 1099511628211ULL;
+    }
+    const uint32_t* offsets = ret.getOffsets(i);
+    for (size_t j = 0; j < ret.getOffsetN(i); ++j){
+      h = (h ^ offsets[j]) * 1099511628211ULL;
+    }
+  }
+  return h;
+}
+
+struct QueryStat{
+  double time;
+  uint64_t digest;
+  size_t docN;
+  size_t posN;
+};
+
+struct EngineStat{
+  double buildTime;
+  size_t indexSize;
+  size_t fileSize;
+  double loadTime;
+  long baseRSS;
+  long peakRSS;
+  vector<vector<QueryStat> > queries; ///< queries[mix]
+};
+
+/// Build, save, load and search by an engine. Run in a child process.
+int runEngine(const Corpus& corpus, const string& method, const string& cm_s, 
+	      const string& index, FILE* out){
+  const long baseRSS = getRSS();
+  Minise* ms = initMinise(method, cm_s);
+  if (ms == NULL) return -1;
+
+  double start = gettimeofday_sec();
+  for (size_t i = 0; i < corpus.docs.size(); ++i){
+    ostringstream title;
+    title << corpus.name << i;
+    ms->addDoc(title.str().c_str(), vector<uint8_t>(corpus.docs[i].begin(), corpus.docs[i].end()));
+  }
+  if (ms->build() == -1 || ms->save(index.c_str()) == -1){
+    cerr << ms->what() << endl;
+    delete ms;
+    return -1;
+  }
+  const double buildTime = gettimeofday_sec() - start;
+  const size_t indexSize = ms->getIndexSize();
+  delete ms;
+
+  struct stat st;
+  const size_t fileSize = (stat(index.c_str(), &st) == 0) ? st.st_size : 0;
+
+  start = gettimeofday_sec();
+  Minise::IndexType indexType = Minise::QUICKSEARCH;
+  if (getIndexType(index.c_str(), indexType) == -1) return -1;
+  ms = newMinise(indexType);
+  if (ms == NULL || ms->load(index.c_str()) == -1){
+    if (ms != NULL) cerr << ms->what() << endl;
+    delete ms;
+    return -1;
+  }
+  const double loadTime = gettimeofday_sec() - start;
+
+  fprintf(out, "%f %lu %lu %f\n", buildTime, (unsigned long)indexSize, 
+	  (unsigned long)fileSize, loadTime);
+  ResultSet ret;
+  SearchContext ctx;
+  for (size_t m = 0; m < mixN; ++m){
+    const vector<string>& queries(corpus.queries[m]);
+    for (size_t q = 0; q < queries.size(); ++q){
+      start = gettimeofday_sec();
+      ms->search(queries[q].c_str(), queries[q].size(), ret, ctx);
+      const double time = gettimeofday_sec() - start;
+      fprintf(out, "%.9f %llu %lu %lu\n", time, (unsigned long long)digest(ret), 
+	      (unsigned long)ret.size(), (unsigned long)ret.getOffsetN());
+    }
+  }
+
+  // Top 0 documents are always empty
+  for (size_t m = 0; m < mixN; ++m){
+    const vector<string>& queries(corpus.queries[m]);
+    for (size_t q = 0; q < queries.size(); ++q){
+      if (ms->searchTopK(queries[q].c_str(), queries[q].size(), 0, ret) != 0 || ret.size() != 0 ||
+	  ms->searchTopKOR(queries[q].c_str(), queries[q].size(), 0, ret) != 0 || ret.size() != 0){
+	cerr << "top 0 documents are not empty: " << queries[q] << endl;
+	delete ms;
+	return -1;
+      }
+    }
+  }
+  delete ms;
+  unlink(index.c_str());
+
+  struct rusage ru;
+  getrusage(RUSAGE_SELF, &ru);
+  fprintf(out, "%ld %ld\n", baseRSS, ru.ru_maxrss); // Kilo bytes on Linux
+  return 0;
+}
+
+int forkEngine(const Corpus& corpus, const string& method, const string& cm_s, 
+	       const string& index, EngineStat& es){
+  int fds[2];
+  if (pipe(fds) == -1) return -1;
+  cout << flush;
+  cerr << flush;
+  const pid_t pid = fork();
+  if (pid == -1){
+    close(fds[0]);
+    close(fds[1]);
+    return -1;
+  }
+  if (pid == 0){
+    close(fds[0]);
+    FILE* out = fdopen(fds[1], "w");
+    const int ret = (out == NULL) ? -1 : runEngine(corpus, method, cm_s, index, out);
+    if (out != NULL) fclose(out);
+    _exit(ret == 0 ? 0 : 1);
+  }
+
+  close(fds[1]);
+  FILE* in = fdopen(fds[0], "r");
+  bool ok = (in != NULL);
+  unsigned long indexSize = 0, fileSize = 0;
+  ok = ok && fscanf(in, "%lf %lu %lu %lf", &es.buildTime, &indexSize, &fileSize, &es.loadTime) == 4;
+  es.indexSize = indexSize;
+  es.fileSize  = fileSize;
+  es.queries.assign(mixN, vector<QueryStat>());
+  for (size_t m = 0; ok && m < mixN; ++m){
+    es.queries[m].resize(corpus.queries[m].size());
+    for (size_t q = 0; ok && q < es.queries[m].size(); ++q){
+      QueryStat& qs(es.queries[m][q]);
+      unsigned long long d = 0;
+      unsigned long docN = 0, posN = 0;
+      ok = fscanf(in, "%lf %llu %lu %lu", &qs.time, &d, &docN, &posN) == 4;
+      qs.digest = d;
+      qs.docN   = docN;
+      qs.posN   = posN;
+    }
+  }
+  ok = ok && fscanf(in, "%ld %ld", &es.baseRSS, &es.peakRSS) == 2;
+  if (in != NULL){
+    fclose(in);
+  } else {
+    close(fds[0]);
+  }
+
+  int status = 0;
+  waitpid(pid, &status, 0);
+  if (!ok || !WIFEXITED(status) || WEXITSTATUS(status) != 0) return -1;
+  return 0;
+}
+
+/// p-th percentile (nearest rank) of sorted values
+double percentile(const vector<double>& sorted, const double p){
+  if (sorted.size() == 0) return 0.0;
+  size_t rank = static_cast<size_t>(ceil(p * sorted.size() / 100.0));
+  if (rank == 0) rank = 1;
+  return sorted[min(rank, sorted.size()) - 1];
+}
+
+void split(const string& s, vector<string>& vs){
+  vs.clear();
+  istringstream is(s);
+  string v;
+  while (getline(is, v, ',')){
+    if (v != "") vs.push_back(v);
+  }
+}
+
+int runBench(const parser& p){
+  vector<string> corpusNames, docNs, docLens, methods, codecs;
+  split(p.get<string>("corpus"), corpusNames);
+  split(p.get<string>("docs"), docNs);
+  split(p.get<string>("length"), docLens);
+  split(p.get<string>("methods"), methods);
+  split(p.get<string>("compress"), codecs);
+  const size_t queryN = p.get<int>("queries");
+  const uint32_t seed = p.get<int>("seed");
+  const string index  = p.get<string>("dir") + "/minise_bench.idx";
+
+  for (size_t c = 0; c < corpusNames.size(); ++c){
+    if (corpusNames[c] != "ascii" && corpusNames[c] != "ja"){
+      cerr << "Unknown corpus : " << corpusNames[c] << endl;
+      return -1;
+    }
+  }
+
+  cout << "corpus\tdocs\tdoc_bytes\tmethod\tcodec\tbuild_sec\tindex_bytes\tfile_bytes\tload_sec\t"
+       << "base_rss_kb\tpeak_rss_kb\tmix\tqueries\thit_docs\thit_positions\t"
+       << "p50_us\tp95_us\tp99_us\tqps\tcheck" << endl;
+
+  int mismatchN = 0;
+  for (size_t c = 0; c < corpusNames.size(); ++c){
+    for (size_t d = 0; d < docNs.size(); ++d){
+      for (size_t l = 0; l < docLens.size(); ++l){
+	Corpus corpus;
+	genCorpus(corpusNames[c], atoi(docNs[d].c_str()), atoi(docLens[l].c_str()), 
+		  queryN, seed, corpus);
+
+	// Reference digests for substring engines and inverted files
+	vector<vector<QueryStat> > refs[2];
+	for (size_t m = 0; m < methods.size(); ++m){
+	  for (size_t k = 0; k < codecs.size(); ++k){
+	    Minise* ms = initMinise(methods[m], codecs[k]);
+	    if (ms == NULL) continue; // Not supported combination
+	    delete ms;
+
+	    cerr << corpus.name << " " << corpus.docN << " " << corpus.docLen << " " 
+		 << methods[m] << " " << codecs[k] << endl;
+	    EngineStat es;
+	    if (forkEngine(corpus, methods[m], codecs[k], index, es) == -1){
+	      cerr << "failed : " << methods[m] << " " << codecs[k] << endl;
+	      mismatchN++;
+	      continue;
+	    }
+
+	    vector<vector<QueryStat> >& ref(refs[methods[m] == "inv" ? 1 : 0]);
+	    const bool isRef = ref.empty();
+	    if (isRef) ref = es.queries;
+
+	    for (size_t mix = 0; mix < mixN; ++mix){
+	      const vector<QueryStat>& qs(es.queries[mix]);
+	      vector<double> times;
+	      double total = 0.0;
+	      size_t docHit = 0, posHit = 0, diffN = 0;
+	      for (size_t q = 0; q < qs.size(); ++q){
+		times.push_back(qs[q].time);
+		total  += qs[q].time;
+		docHit += qs[q].docN;
+		posHit += qs[q].posN;
+		diffN  += (qs[q].digest != ref[mix][q].digest);
+	      }
+	      sort(times.begin(), times.end());
+	      mismatchN += (diffN > 0);
+
+	      ostringstream check;
+	      if (isRef){
+		check << "ref";
+	      } else if (diffN == 0){
+		check << "ok";
+	      } else {
+		check << "diff(" << diffN << ")";
+	      }
+	      cout << corpus.name << "\t" << corpus.docN << "\t" << corpus.docLen << "\t" 
+		   << methods[m] << "\t" << codecs[k] << "\t"
+		   << fixed << setprecision(6) << es.buildTime << "\t" 
+		   << es.indexSize << "\t" << es.fileSize << "\t" << es.loadTime << "\t"
+		   << es.baseRSS << "\t" << es.peakRSS << "\t"
+		   << mixNames[mix] << "\t" << qs.size() << "\t" << docHit << "\t" << posHit << "\t"
+		   << setprecision(1) << percentile(times, 50) * 1e6 << "\t" 
+		   << percentile(times, 95) * 1e6 << "\t" 
+		   << percentile(times, 99) * 1e6 << "\t"
+		   << ((total > 0.0) ? qs.size() / total : 0.0) << "\t"
+		   << check.str() << endl;
+	    }
+	  }
+	}
+      }
+    }
+  }
+
+  if (mismatchN > 0){
+    cerr << mismatchN << " mismatches or failures" << endl;
+    return -1;
+  }
+  return 0;
+}
+
+int main(int argc, char* argv[]){
+  parser p;
+  p.set_progam_name(string("minise_bench"));
+  p.add<string>("corpus", 'p', "Synthetic corpora: (ascii|ja), comma separated ", false, "ascii,ja");
+  p.add<string>("docs", 'n', "Numbers of documents, comma separated ", false, "200,2000");
+  p.add<string>("length", 'l', "Document lengths in bytes, comma separated ", false, "2000");
+  p.add<string>("methods", 'm', "Index methods: (seq|inv|1gram|2gram|sa|sa8|fm), comma separated ", 
+		false, "seq,inv,1gram,2gram,sa,sa8,fm");
+  p.add<string>("compress", 'c', "Compress methods: (none|vb|rc|bp|svb|ef), comma separated ", 
+		false, "none,vb,rc,bp,svb,ef");
+  p.add<int>("queries", 'q', "Number of queries in each mix ", false, 200);
+  p.add<int>("seed", 's', "Random seed ", false, 1);
+  p.add<string>("dir", 'd', "Directory for a temporary index ", false, ".");
+  p.add("help", 'h', "Print help");
+
+  if (!p.parse(argc, argv) || p.exist("help")){
+    if (p.exist("help")){
+      cerr << p.usage() << endl;
+    } else {
+      cerr << p.error() << p.usage() << endl;
+    }
+    return -1;
+  }
+
+  if (runBench(p) == -1){
+    return -1;
+  }
+  return 0;
+}
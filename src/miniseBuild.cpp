@@ -27,6 +27,7 @@
 #include <iostream>
 #include <string>
 #include <fstream>
+#include <sstream>
 #include "minise.hpp"
 #include "cmdline.h"
 #include "timer.hpp"
@@ -35,7 +36,8 @@ using namespace std;
 using namespace SE;
 using namespace cmdline;
 
-Minise* initMinise(const string& method, const string& cm_s){
+Minise* initMinise(const string& method, const string& cm_s, const int bucketLen, 
+		   const bool docList, const int sampleRate, const int threadN){
   Minise* ms = NULL;
   InvertedFile::compressMethod cm = InvertedFile::NONE;
   if (cm_s == "none"){
@@ -44,6 +46,12 @@ Minise* initMinise(const string& method, const string& cm_s){
     cm = InvertedFile::VARBYTE;
   } else if (cm_s == "rc"){
     cm = InvertedFile::RICECODE;
+  } else if (cm_s == "bp"){
+    cm = InvertedFile::BINARYPACKING;
+  } else if (cm_s == "svb"){
+    cm = InvertedFile::STREAMVBYTE;
+  } else if (cm_s == "ef"){
+    cm = InvertedFile::ELIASFANO;
   } else {
     cerr << "Unkwnon compress method : " << cm_s << endl;
     return ms;
@@ -65,24 +73,95 @@ Minise* initMinise(const string& method, const string& cm_s){
     static_cast<InvertedFile*>(ms)->setCompressMethod(cm);
   } else if (method == "sa"){
     ms = new SuffixArray;
+    static_cast<SuffixArray*>(ms)->setBucketLength(bucketLen);
+    static_cast<SuffixArray*>(ms)->setThreadN(threadN);
+    if (docList) static_cast<SuffixArray*>(ms)->setDocList();
   } else if (method == "sa8"){
     ms = new SuffixArray;
     static_cast<SuffixArray*>(ms)->setUTF8();
+    static_cast<SuffixArray*>(ms)->setBucketLength(bucketLen);
+    static_cast<SuffixArray*>(ms)->setThreadN(threadN);
+    if (docList) static_cast<SuffixArray*>(ms)->setDocList();
+  } else if (method == "fm"){
+    ms = new FMIndex;
+    static_cast<FMIndex*>(ms)->setSampleRate(sampleRate);
+    static_cast<FMIndex*>(ms)->setThreadN(threadN);
   } else {
     // Nothing
   }
   return ms;
 }
 
-int buildIndex(const parser& p){
+/// Spool documents to tmpPrefix.* and sort suffixes in memMB MB (sa only)
+int initExternal(Minise* ms, const string& tmpPrefix, const int memMB){
+  if (memMB == 0) return 0;
+  SuffixArray* sa = static_cast<SuffixArray*>(ms);
+  if (sa->setExternal(tmpPrefix, static_cast<size_t>(memMB) << 20) == -1){
+    cerr << sa->what() << endl;
+    return -1;
+  }
+  return 0;
+}
+
+int buildIndex(parser& p){
   string method = p.get<string>("method");
   string list   = p.get<string>("list");
   string index  = p.get<string>("index");
   string cm_s   = p.get<string>("compress");
+  int threadN   = p.get<int>("threads");
+  int shardN    = p.get<int>("shards");
+  int bucketLen = p.get<int>("buckets");
+  int sampleRate = p.get<int>("sample");
+  int memMB     = p.get<int>("memory");
+  bool docList  = p.exist("doclist");
   string usage  = p.usage();
 
+  if (bucketLen < 0 || bucketLen > 3){
+    cerr << "The bucket length should be 0-3 : " << bucketLen << endl;
+    return -1;
+  }
+  if (sampleRate <= 0){
+    cerr << "The sample rate should be positive : " << sampleRate << endl;
+    return -1;
+  }
+  if (docList && method != "sa" && method != "sa8"){
+    cerr << "A document list is only for sa, sa8 : " << method << endl;
+    return -1;
+  }
+  if (memMB < 0 || (memMB > 0 && method != "sa")){
+    cerr << "Out of core build is only for sa with positive memory : " << memMB << endl;
+    return -1;
+  }
+
 
-  Minise* ms = initMinise(method, cm_s);
+  Minise* ms = NULL;
+  if (shardN > 1){
+    vector<Minise*> shards;
+    for (int i = 0; i < shardN; ++i){
+      Minise* shard = initMinise(method, cm_s, bucketLen, docList, sampleRate, 1);
+      if (shard == NULL) break;
+      ostringstream tmpPrefix;
+      tmpPrefix << index << ".tmp." << i;
+      if (initExternal(shard, tmpPrefix.str(), memMB) == -1){
+	delete shard;
+	break;
+      }
+      shards.push_back(shard);
+    }
+    if ((int)shards.size() == shardN){
+      ms = new ShardedMinise(shards);
+    } else {
+      for (size_t i = 0; i < shards.size(); ++i){
+	delete shards[i];
+      }
+    }
+  } else {
+    ms = initMinise(method, cm_s, bucketLen, docList, sampleRate, threadN);
+    if (ms != NULL && initExternal(ms, index + ".tmp", memMB) == -1){
+      delete ms;
+      ms = NULL;
+    }
+  }
   if (ms == NULL){
     cerr << usage << endl;
     return -1;
@@ -106,14 +185,22 @@ int buildIndex(const parser& p){
 
   double start = gettimeofday_sec();
   string fileName;
-  for (size_t i = 0; i < files.size(); ++i){
-    if (ms->addFile(files[i].c_str()) == -1){
+  if (threadN > 1){
+    if (ms->addFiles(files, threadN) == -1){
       cerr << ms->what() << endl;
       delete ms;
       return -1;
     }
-    if (((i+1) % 1000) == 0){
-      cout << i+1 << "\r" << flush;
+  } else {
+    for (size_t i = 0; i < files.size(); ++i){
+      if (ms->addFile(files[i].c_str()) == -1){
+	cerr << ms->what() << endl;
+	delete ms;
+	return -1;
+      }
+      if (((i+1) % 1000) == 0){
+	cout << i+1 << "\r" << flush;
+      }
     }
   }
 
@@ -145,10 +232,16 @@ int buildIndex(const parser& p){
 int main(int argc, char* argv[]){
   parser p;
   p.set_progam_name(string("minise_build"));
-  p.add<string>("method", 'm', "Index method: (seq|inv|1gram|2gram|sa|sa8) ", false, "1gram");
+  p.add<string>("method", 'm', "Index method: (seq|inv|1gram|2gram|sa|sa8|fm) ", false, "1gram");
   p.add<string>("list", 'l', "File list ", true);
   p.add<string>("index", 'i', "Index file ", true);
-  p.add<string>("compress", 'c', "Compress method: (none|vb|rc)  for inv, 1gram, 2gram ", false, "none");
+  p.add<string>("compress", 'c', "Compress method: (none|vb|rc|bp|svb|ef)  for inv, 1gram, 2gram ", false, "none");
+  p.add<int>("threads", 't', "Number of threads for reading and parsing files, and sorting suffixes for sa, sa8, fm ", false, 1);
+  p.add<int>("shards", 's', "Number of shards (each shard is saved to index.0, index.1, ...) ", false, 1);
+  p.add<int>("sample", 'r', "Sampling rate of SA and inverse SA for fm (memory vs locate time) ", false, 32);
+  p.add<int>("buckets", 'b', "Bytes of suffix prefixes to look up SA ranges for sa, sa8 (0-3, a table of 256^b entries) ", false, 0);
+  p.add<int>("memory", 'e', "Build sa out of core, spooling the text and sorting suffixes in this many MB (0 for in memory) ", false, 0);
+  p.add("doclist", 'd', "Build a document list for sa, sa8 to list hit documents without visiting all positions (-r docs of minise_search) ");
   p.add("help", 'h', "Print help");
   
   if (!p.parse(argc, argv)){
@@ -27,8 +27,12 @@
 #include <iostream>
 #include <string>
 #include <fstream>
+#include <sstream>
 #include <iomanip>
+#include <algorithm>
+#include <pthread.h>
 #include "minise.hpp"
+#include "parallel.hpp"
 #include "cmdline.h"
 #include "timer.hpp"
 
@@ -44,31 +48,226 @@ void removeNL(string& snippet){
   }
 }
 
-void printResult(const Minise* ms, const vector<SeResult>& ret, 
-		 const int num, const int snum, const int slen){
-  size_t total = 0;
-  for (size_t i = 0; i < ret.size(); ++i){
-    total += ret[i].offsets.size();
-  }
-  cout << "Hit " << ret.size() << " documents. " << total << " positions." << endl;
+void printResult(const Minise* ms, const ResultSet& ret, const bool showScore,
+		 const int num, const int snum, const int slen, ostream& os){
   for (int i = 0; i < num && i < (int)ret.size(); ++i){
-    const SeResult& sr(ret[i]);
-    cout << " Title: " << sr.title << endl;
-    cout << " DocID: " << sr.docID << endl;
-    cout << "HitPos: " << sr.offsets.size() << endl;
-    for (int j = 0; j < (int)sr.offsets.size() && j < snum; ++j){
+    const uint32_t docID = ret.getDocID(i);
+    const uint32_t* offsets = ret.getOffsets(i);
+    const int offsetN = static_cast<int>(ret.getOffsetN(i));
+    os << " Title: " << ms->getTitle(docID) << endl;
+    os << " DocID: " << docID << endl;
+    if (showScore){
+      os << " Score: " << ret.getScore(i) << endl;
+    }
+    os << "HitPos: " << offsetN << endl;
+    for (int j = 0; j < offsetN && j < snum; ++j){
       string snippet;
-      ms->getSnippet(sr.docID, sr.offsets[j], slen, snippet);
+      ms->getSnippet(docID, offsets[j], slen, snippet);
       removeNL(snippet);
-      cout << setw(10) << sr.offsets[j] << "\t" << snippet << "\t" << endl;
+      os << setw(10) << offsets[j] << "\t" << snippet << "\t" << endl;
     }
-    cout << endl;
+    os << endl;
   }
   
 }
 
-int searchIndex(const string& index, const int num, 
-		const int snum, const int slen, const string& usage){
+/// Print documents with the most occurrences first
+void printDocs(const Minise* ms, const vector<uint32_t>& docIDs, const vector<uint32_t>& counts,
+	       const int num, ostream& os){
+  vector<pair<uint32_t, uint32_t> > ranked(docIDs.size()); // (count, docID)
+  for (size_t i = 0; i < docIDs.size(); ++i){
+    ranked[i] = make_pair(counts[i], docIDs[i]);
+  }
+  const size_t k = min(static_cast<size_t>(max(num, 0)), ranked.size());
+  partial_sort(ranked.begin(), ranked.begin() + k, ranked.end(), greater<pair<uint32_t, uint32_t> >());
+  for (size_t i = 0; i < k; ++i){
+    os << " Title: " << ms->getTitle(ranked[i].second) << endl;
+    os << " DocID: " << ranked[i].second << endl;
+    os << "HitPos: " << ranked[i].first << endl;
+    os << endl;
+  }
+}
+
+/**
+ * Search the query and print its result
+ * @param prof Profile of the query is stored and printed if given
+ * @return Search time in seconds
+ */
+double runQuery(Minise* ms, const string& query, const string& rank, 
+		const int num, const int snum, const int slen, ResultSet& ret, 
+		SearchContext& ctx, QueryProfile* prof, ostream& os){
+  os << "query:[" << query << "]" << endl;
+  if (prof) prof->clear();
+  double start = gettimeofday_sec();
+  double time = 0.0;
+  if (rank == "bm25" || rank == "bm25or"){
+    size_t hitN = (rank == "bm25") ? 
+      ms->searchTopK(query.c_str(), query.size(), num, ret, prof) :
+      ms->searchTopKOR(query.c_str(), query.size(), num, ret, prof);
+    time = gettimeofday_sec() - start;
+    os << "time: " << time * 1000 << " milli seconds." << endl;
+    os << "Hit " << hitN << " documents." << endl;
+  } else if (rank == "docs"){
+    vector<uint32_t> docIDs;
+    vector<uint32_t> counts;
+    ms->listDocs(query.c_str(), query.size(), docIDs, &counts, prof);
+    time = gettimeofday_sec() - start;
+    uint64_t posN = 0;
+    for (size_t i = 0; i < counts.size(); ++i){
+      posN += counts[i];
+    }
+    os << "time: " << time * 1000 << " milli seconds." << endl;
+    os << "Hit " << docIDs.size() << " documents. " << posN << " positions." << endl;
+    if (prof) prof->print(os);
+    printDocs(ms, docIDs, counts, num, os);
+    return time;
+  } else {
+    ms->search(query.c_str(), query.size(), ret, ctx, prof);
+    {
+      ProfileTimer timer(prof, QueryProfile::RANK);
+      ret.rankByTF();
+    }
+    time = gettimeofday_sec() - start;
+    os << "time: " << time * 1000 << " milli seconds." << endl;
+    os << "Hit " << ret.size() << " documents. " << ret.getOffsetN() << " positions." << endl;
+  }
+  if (prof) prof->print(os);
+  printResult(ms, ret, rank != "tf", num, snum, slen, os);
+  return time;
+}
+
+/**
+ * Run queries [beg, end) by several threads.
+ * Each thread takes the next query one by one, and 
+ * keeps its output so that outputs are printed in input order.
+ */
+class BatchTask : public ParallelTask {
+public:
+  BatchTask(Minise* ms, const vector<string>& queries, const size_t beg, const size_t end,
+	    const string& rank, const int num, const int snum, const int slen, 
+	    vector<double>& times, vector<QueryProfile>* profs) : 
+    ms(ms), queries(queries), beg(beg), end(end), rank(rank), 
+    num(num), snum(snum), slen(slen), times(times), profs(profs), outputs(end - beg), next(beg) {
+    pthread_mutex_init(&mutex, NULL);
+  }
+
+  ~BatchTask(){
+    pthread_mutex_destroy(&mutex);
+  }
+
+  void run(const int threadID){
+    ResultSet ret; // Reused for queries of this thread
+    SearchContext ctx;
+    QueryProfile prof;
+    for (;;){
+      pthread_mutex_lock(&mutex);
+      const size_t i = next++;
+      pthread_mutex_unlock(&mutex);
+      if (i >= end) break;
+
+      ostringstream os;
+      times[i] = runQuery(ms, queries[i], rank, num, snum, slen, ret, ctx, 
+			  profs ? &prof : NULL, os);
+      outputs[i - beg] = os.str();
+      if (profs) (*profs)[threadID].add(prof);
+    }
+  }
+
+  const vector<string>& getOutputs() const{
+    return outputs;
+  }
+
+private:
+  Minise* ms;
+  const vector<string>& queries;
+  const size_t beg;
+  const size_t end;
+  const string& rank;
+  const int num;
+  const int snum;
+  const int slen;
+  vector<double>& times;
+  vector<QueryProfile>* profs; ///< Sum of profiles for each thread
+  vector<string> outputs;
+  size_t next;
+  pthread_mutex_t mutex;
+};
+
+/// p-th percentile (nearest rank) of sorted values
+double percentile(const vector<double>& sorted, const double p){
+  if (sorted.size() == 0) return 0.0;
+  size_t rank = static_cast<size_t>(p * sorted.size() / 100.0 + 0.999999);
+  if (rank == 0) rank = 1;
+  return sorted[min(rank, sorted.size()) - 1];
+}
+
+int searchBatch(Minise* ms, const string& queryFile, const int threadN, const string& rank,
+		const int num, const int snum, const int slen, const bool profile){
+  ifstream ifs(queryFile.c_str());
+  if (!ifs){
+    cerr << "cannot open " << queryFile << endl;
+    return -1;
+  }
+  vector<string> queries;
+  string query;
+  while (getline(ifs, query)){
+    queries.push_back(query);
+  }
+
+  // Queries are run by chunks so that outputs are not kept for all queries
+  const size_t chunkSize = 1024 * static_cast<size_t>(threadN);
+  vector<double> times(queries.size());
+  vector<QueryProfile> profs(threadN);
+  double total = 0.0;
+  for (size_t beg = 0; beg < queries.size(); beg += chunkSize){
+    const size_t end = min(beg + chunkSize, queries.size());
+    BatchTask task(ms, queries, beg, end, rank, num, snum, slen, times, 
+		   profile ? &profs : NULL);
+    double start = gettimeofday_sec();
+    if (runParallel(task, threadN) == -1){
+      cerr << "cannot create threads" << endl; // Created threads run all queries
+    }
+    total += gettimeofday_sec() - start;
+
+    const vector<string>& outputs(task.getOutputs());
+    for (size_t i = 0; i < outputs.size(); ++i){
+      cout << ">" << outputs[i];
+    }
+  }
+  cout << ">" << endl;
+
+  sort(times.begin(), times.end());
+  cout << "queries: " << queries.size() << endl
+       << "threads: " << threadN << endl
+       << "   time: " << total << " seconds." << endl
+       << "    QPS: " << ((total > 0.0) ? queries.size() / total : 0.0) << endl
+       << "latency: p50 " << percentile(times, 50) * 1000 
+       << " p95 " << percentile(times, 95) * 1000
+       << " p99 " << percentile(times, 99) * 1000 << " milli seconds." << endl;
+  if (profile){
+    QueryProfile sum;
+    for (size_t i = 0; i < profs.size(); ++i){
+      sum.add(profs[i]);
+    }
+    cout << "average per query" << endl;
+    sum.print(cout, queries.size());
+  }
+  return 0;
+}
+
+int searchIndex(const string& index, const string& rank, const int num, 
+		const int snum, const int slen, const string& queryFile, 
+		const int threadN, const int scanThreadN, const bool profile, const string& usage){
+  if (rank != "bm25" && rank != "bm25or" && rank != "tf" && rank != "docs"){
+    cerr << "Unknown ranking method : " << rank << endl;
+    cerr << usage << endl;
+    return -1;
+  }
+  if (threadN < 1 || scanThreadN < 1){
+    cerr << "The number of threads should be positive : " << threadN << " " << scanThreadN << endl;
+    return -1;
+  }
+
   Minise::IndexType indexType = Minise::QUICKSEARCH;
   if(getIndexType(index.c_str(), indexType) == -1){
     cerr << "searchIndex read error: " << index << endl;
@@ -78,6 +277,11 @@ int searchIndex(const string& index, const int num,
   Minise* ms = NULL;
   if (indexType == Minise::QUICKSEARCH){
     ms = new QuickSearch;
+    if (static_cast<QuickSearch*>(ms)->setThreadN(scanThreadN) == -1){
+      cerr << ms->what() << endl;
+      delete ms;
+      return -1;
+    }
   } else if (indexType == Minise::ONEGRAM ||
 	     indexType == Minise::TWOGRAM ||
 	     indexType == Minise::INVERTEDFILE){
@@ -85,6 +289,10 @@ int searchIndex(const string& index, const int num,
   } else if (indexType == Minise::SUFFIXARRAY ||
 	     indexType == Minise::SUFFIXARRAY_UTF8){
     ms = new SuffixArray;
+  } else if (indexType == Minise::FMINDEX){
+    ms = new FMIndex;
+  } else if (indexType == Minise::SHARDED){
+    ms = new ShardedMinise;
   } else {
     cerr << "indexType:" << indexType << endl;
     return -1;
@@ -101,17 +309,20 @@ int searchIndex(const string& index, const int num,
        << " termN: " << ms->getTermN() << endl
        << "  size: " << ms->getIndexSize() << endl;
 
+  if (queryFile != ""){
+    const int ret = searchBatch(ms, queryFile, threadN, rank, num, snum, slen, profile);
+    delete ms;
+    return ret;
+  }
+
   string query;
+  ResultSet ret; // Reused for all queries
+  SearchContext ctx;
+  QueryProfile prof;
   for (;;){
     cout << ">";
     if (!getline(cin, query)) break;
-    
-    cout << "query:[" << query << "]" << endl;
-    vector<SeResult> ret;
-    double start = gettimeofday_sec();
-    ms->search(query.c_str(), query.size(), ret);
-    cout << "time: " << (gettimeofday_sec() - start) * 1000 << " milli seconds." << endl;
-    printResult(ms, ret, num, snum, slen);
+    runQuery(ms, query, rank, num, snum, slen, ret, ctx, profile ? &prof : NULL, cout);
   }
 
   delete ms;
@@ -122,9 +333,14 @@ int main(int argc, char* argv[]){
   parser p;
   p.set_progam_name(string("minise_search"));
   p.add<string>("index", 'i', "Index file ", true);
+  p.add<string>("rank", 'r', "Ranking method: (bm25|bm25or|tf|docs) bm25or ranks documents containing any term, docs lists documents by occurrences without positions ", false, "bm25");
   p.add<int>("num", 'n', "Result Num ", false, 5);
   p.add<int>("snippetnum", 's', "Snippet Num ", false, 3);
   p.add<int>("snippetlen", 'l', "Snippet Length ", false, 60);
+  p.add<string>("queries", 'q', "Query file for batch mode (one query per line) ", false, "");
+  p.add<int>("threads", 't', "Number of threads for batch mode ", false, 1);
+  p.add<int>("scanthreads", 'c', "Number of threads to scan the text of seq for each query ", false, 1);
+  p.add("profile", 'p', "Print stage durations and counters of each query (and their average in batch mode)");
   p.add("help", 'h', "Print help");
   
   if (!p.parse(argc, argv)){
@@ -137,9 +353,14 @@ int main(int argc, char* argv[]){
   }
 
   if (searchIndex(p.get<string>("index"), 
+		  p.get<string>("rank"),
 		  p.get<int>("num"),
 		  p.get<int>("snippetnum"),
 		  p.get<int>("snippetlen"), 
+		  p.get<string>("queries"),
+		  p.get<int>("threads"),
+		  p.get<int>("scanthreads"),
+		  p.exist("profile"),
 		  p.usage()) == -1){
     return -1;
   }
@@ -0,0 +1,172 @@
+/*
+ * parallel.cpp
+ * Copyright (c) 2009 Daisuke Okanohara All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "parallel.hpp"
+
+using namespace std;
+
+namespace SE{
+
+namespace {
+
+struct ThreadArg{
+  ParallelTask* task;
+  int threadID;
+};
+
+void* threadMain(void* p){
+  ThreadArg* arg = static_cast<ThreadArg*>(p);
+  arg->task->run(arg->threadID);
+  return NULL;
+}
+
+}
+
+ParallelTask::~ParallelTask(){
+}
+
+int runParallel(ParallelTask& task, const int threadN){
+  if (threadN <= 1){
+    task.run(0);
+    return 0;
+  }
+
+  vector<ThreadArg> args(threadN);
+  vector<pthread_t> threads(threadN);
+  int created = 0;
+  for (; created < threadN; ++created){
+    args[created].task     = &task;
+    args[created].threadID = created;
+    if (pthread_create(&threads[created], NULL, threadMain, &args[created]) != 0){
+      break;
+    }
+  }
+
+  for (int i = 0; i < created; ++i){
+    pthread_join(threads[i], NULL);
+  }
+  return (created == threadN) ? 0 : -1;
+}
+
+ThreadPool::ThreadPool() : task(NULL), taskN(0), next(0), done(0), stop(false) {
+  pthread_mutex_init(&runMutex, NULL);
+  pthread_mutex_init(&mutex, NULL);
+  pthread_cond_init(&workCond, NULL);
+  pthread_cond_init(&doneCond, NULL);
+}
+
+ThreadPool::~ThreadPool(){
+  pthread_mutex_lock(&mutex);
+  stop = true;
+  pthread_cond_broadcast(&workCond);
+  pthread_mutex_unlock(&mutex);
+  for (size_t i = 0; i < threads.size(); ++i){
+    pthread_join(threads[i], NULL);
+  }
+
+  pthread_cond_destroy(&doneCond);
+  pthread_cond_destroy(&workCond);
+  pthread_mutex_destroy(&mutex);
+  pthread_mutex_destroy(&runMutex);
+}
+
+int ThreadPool::start(const int threadN){
+  for (int i = 0; i < threadN; ++i){
+    pthread_t th;
+    if (pthread_create(&th, NULL, workerMain, this) != 0){
+      return -1;
+    }
+    threads.push_back(th);
+  }
+  return 0;
+}
+
+void* ThreadPool::workerMain(void* p){
+  static_cast<ThreadPool*>(p)->work();
+  return NULL;
+}
+
+void ThreadPool::work(){
+  pthread_mutex_lock(&mutex);
+  for (;;){
+    while (!stop && (task == NULL || next >= taskN)){
+      pthread_cond_wait(&workCond, &mutex);
+    }
+    if (stop) break;
+    pthread_mutex_unlock(&mutex);
+    runOne();
+    pthread_mutex_lock(&mutex);
+  }
+  pthread_mutex_unlock(&mutex);
+}
+
+/// Run one call of the current task. Return false if no call remains.
+bool ThreadPool::runOne(){
+  pthread_mutex_lock(&mutex);
+  if (task == NULL || next >= taskN){
+    pthread_mutex_unlock(&mutex);
+    return false;
+  }
+  ParallelTask* t = task;
+  const int id = next++;
+  pthread_mutex_unlock(&mutex);
+
+  t->run(id);
+
+  pthread_mutex_lock(&mutex);
+  if (++done == taskN){
+    pthread_cond_signal(&doneCond);
+  }
+  pthread_mutex_unlock(&mutex);
+  return true;
+}
+
+void ThreadPool::run(ParallelTask& task_, const int taskN_){
+  if (taskN_ <= 0) return;
+  pthread_mutex_lock(&runMutex);
+
+  pthread_mutex_lock(&mutex);
+  task  = &task_;
+  taskN = taskN_;
+  next  = 0;
+  done  = 0;
+  pthread_cond_broadcast(&workCond);
+  pthread_mutex_unlock(&mutex);
+
+  while (runOne()){
+  }
+
+  pthread_mutex_lock(&mutex);
+  while (done < taskN){
+    pthread_cond_wait(&doneCond, &mutex);
+  }
+  task = NULL;
+  pthread_mutex_unlock(&mutex);
+
+  pthread_mutex_unlock(&runMutex);
+}
+
+}
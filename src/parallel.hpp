@@ -0,0 +1,112 @@
+/*
+ * parallel.hpp
+ * Copyright (c) 2009 Daisuke Okanohara All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef PARALLEL_HPP__
+#define PARALLEL_HPP__
+
+#include <vector>
+#include <pthread.h>
+
+namespace SE{
+
+/**
+ * A task executed by several threads.
+ * run() is called once for each thread with its thread ID.
+ */
+class ParallelTask {
+public:
+  virtual ~ParallelTask(); ///< Destructor
+
+  /**
+   * Body of the task
+   * @param threadID An ID of the thread in [0, threadN)
+   */
+  virtual void run(const int threadID) = 0;
+};
+
+/**
+ * Run the task by threadN threads and wait until all of them finish.
+ * @param task A task to be executed
+ * @param threadN The number of threads
+ * @return Return 0 if it succeded or -1 if failed to create threads
+ */
+int runParallel(ParallelTask& task, const int threadN);
+
+/**
+ * Fixed set of worker threads which run ParallelTasks repeatedly
+ * without creating threads for each task.
+ */
+class ThreadPool {
+public:
+  ThreadPool();  ///< Constructor
+  ~ThreadPool(); ///< Destructor (stop workers)
+
+  /**
+   * Create worker threads
+   * @param threadN The number of worker threads
+   * @return Return 0 if it succeded or -1 if failed
+   */
+  int start(const int threadN);
+
+  /**
+   * Call task.run(i) for each i in [0, taskN) and wait until all of them finish.
+   * The calling thread also runs them, so this works without workers.
+   * Calls from several threads are executed one by one.
+   * @param task A task to be executed
+   * @param taskN The number of calls
+   */
+  void run(ParallelTask& task, const int taskN);
+
+  /**
+   * @return The number of worker threads
+   */
+  int getThreadN() const {
+    return static_cast<int>(threads.size());
+  }
+
+private:
+  ThreadPool(const ThreadPool&);
+  ThreadPool& operator=(const ThreadPool&);
+
+  static void* workerMain(void* p);
+  void work();
+  bool runOne();
+
+  std::vector<pthread_t> threads;
+  pthread_mutex_t runMutex;  ///< Serialize calls of run()
+  pthread_mutex_t mutex;     ///< Protect following members
+  pthread_cond_t  workCond;  ///< Signaled when a task is given or workers stop
+  pthread_cond_t  doneCond;  ///< Signaled when all calls finish
+  ParallelTask* task;        ///< A current task
+  int taskN;                 ///< The number of calls of the current task
+  int next;                  ///< The next call to be started
+  int done;                  ///< The number of finished calls
+  bool stop;                 ///< Workers should exit
+};
+
+}
+
+#endif // PARALLEL_HPP__
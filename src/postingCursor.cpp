@@ -0,0 +1,117 @@
+/*
+ * postingCursor.cpp
+ * Copyright (c) 2009 Daisuke Okanohara All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <algorithm>
+#include "postingCursor.hpp"
+
+using namespace std;
+
+namespace SE{
+
+PostingCursor::PostingCursor(const uint8_t* data, 
+			     const uint64_t* offsets,
+			     const uint32_t* lasts,
+			     const size_t blockN,
+			     const MappedVector<uint32_t>& tail,
+			     const BlockCodec::Method method,
+			     const size_t blockSize) : 
+  data(data), offsets(offsets), lasts(lasts), blockN(blockN), tail(tail), method(method), 
+  block(0), pos(0), decodedBlock(blockN), decodedBlockN(0), buf(blockSize), prof(NULL) {
+}
+
+void PostingCursor::decodeBlock(){
+  if (decodedBlock == block) return;
+  ProfileTimer timer(prof, QueryProfile::BLOCK_DECODE);
+  if (prof) prof->addCount(QueryProfile::BLOCKS_DECODED, 1);
+  BlockCodec::decode(method, data + offsets[block], offsets[block+1] - offsets[block], 
+		     &buf[0], buf.size());
+  decodedBlock = block;
+  decodedBlockN++;
+}
+
+uint32_t PostingCursor::nextGEQ(const uint32_t target){
+  if (block < blockN){
+    if (lasts[block] < target){
+      // Skip blocks without decoding
+      block = lower_bound(lasts + block + 1, lasts + blockN, target) - lasts;
+      pos = 0;
+    }
+    if (block < blockN){
+      if (decodedBlock != block && BlockCodec::hasNextGEQ(method)){
+	uint32_t value = 0;
+	pos = BlockCodec::nextGEQ(method, data + offsets[block], offsets[block+1] - offsets[block], 
+				  target, pos, value);
+	return value; // lasts[block] >= target
+      }
+      decodeBlock();
+      pos = lower_bound(buf.begin() + pos, buf.end(), target) - buf.begin();
+      return buf[pos]; // lasts[block] >= target
+    }
+  }
+
+  pos = lower_bound(tail.begin() + pos, tail.end(), target) - tail.begin();
+  return (pos < tail.size()) ? tail[pos] : END;
+}
+
+void PostingCursor::getRun(const uint32_t*& p, size_t& len){
+  if (block < blockN){
+    decodeBlock();
+    p   = &buf[0] + pos;
+    len = buf.size() - pos;
+  } else if (pos < tail.size()){
+    p   = tail.begin() + pos;
+    len = tail.size() - pos;
+  } else {
+    p   = NULL;
+    len = 0;
+  }
+}
+
+size_t PostingCursor::countLess(const uint32_t target){
+  size_t n = 0;
+  const uint32_t* p = NULL;
+  size_t len = 0;
+  for (getRun(p, len); len > 0; nextRun(), getRun(p, len)){
+    const size_t c = lower_bound(p, p + len, target) - p;
+    n += c;
+    if (c < len){
+      pos += c;
+      break;
+    }
+  }
+  return n;
+}
+
+void PostingCursor::nextRun(){
+  if (block < blockN){
+    ++block;
+    pos = 0;
+  } else {
+    pos = tail.size();
+  }
+}
+
+}
@@ -0,0 +1,135 @@
+/*
+ * postingCursor.hpp
+ * Copyright (c) 2009 Daisuke Okanohara All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef POSTING_CURSOR_HPP__
+#define POSTING_CURSOR_HPP__
+
+#include <vector>
+#include <stdint.h>
+#include "blockCodec.hpp"
+#include "queryProfile.hpp"
+#include "mappedVector.hpp"
+
+namespace SE{
+
+/**
+ * Forward cursor over a posting list which consists of compressed blocks
+ * followed by an uncompressed tail.
+ * Blocks are skipped using their last positions without decoding,
+ * and each block is decoded at most once.
+ * nextGEQ does not decode blocks which support BlockCodec::nextGEQ.
+ */
+class PostingCursor {
+public:
+  enum {
+    END = 0xFFFFFFFF ///< No more positions
+  };
+
+  /**
+   * @param data The arena of compressed blocks
+   * @param offsets Byte offsets of blocks in data (blockN+1 elements)
+   * @param lasts The last position of each block
+   * @param blockN The number of blocks of blockSize positions
+   * @param tail Uncompressed positions after the blocks
+   * @param method Compress method of blocks
+   * @param blockSize The number of positions in a block
+   */
+  PostingCursor(const uint8_t* data, 
+		const uint64_t* offsets,
+		const uint32_t* lasts,
+		const size_t blockN,
+		const MappedVector<uint32_t>& tail,
+		const BlockCodec::Method method,
+		const size_t blockSize);
+
+  /**
+   * Move to the first position >= target. The cursor never moves backward.
+   * @param target A position
+   * @return The position at the cursor or END
+   */
+  uint32_t nextGEQ(const uint32_t target);
+
+  /**
+   * Get positions from the cursor to the end of the current block (or the tail)
+   * @param p Beginning of positions
+   * @param len The number of positions (0 if the cursor is at END)
+   */
+  void getRun(const uint32_t*& p, size_t& len);
+
+  /**
+   * Move to the beginning of the next block (or the tail)
+   */
+  void nextRun();
+
+  /**
+   * Count positions < target from the cursor, and move to the first position >= target
+   * @param target A position
+   * @return The number of skipped positions
+   */
+  size_t countLess(const uint32_t target);
+
+  /**
+   * @return The current block (blockN for the tail)
+   */
+  size_t getBlock() const {
+    return block;
+  }
+
+  /**
+   * @return The number of decoded blocks
+   */
+  size_t getDecodedBlockN() const {
+    return decodedBlockN;
+  }
+
+  /**
+   * Add decoding time and decoded blocks to the profile
+   * @param prof A profile or NULL
+   */
+  void setProfile(QueryProfile* prof_){
+    prof = prof_;
+  }
+
+private:
+  void decodeBlock();
+
+  const uint8_t* data;
+  const uint64_t* offsets;
+  const uint32_t* lasts;
+  const size_t blockN;
+  const MappedVector<uint32_t>& tail;
+  const BlockCodec::Method method;
+  size_t block;         ///< The current block (blockN for the tail)
+  size_t pos;           ///< Offset in the current block or the tail
+  size_t decodedBlock;  ///< The block stored in buf
+  size_t decodedBlockN;
+  std::vector<uint32_t> buf;
+  QueryProfile* prof;
+};
+
+}
+
+#endif // POSTING_CURSOR_HPP__
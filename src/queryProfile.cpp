@@ -0,0 +1,100 @@
+/*
+ * queryProfile.cpp
+ * Copyright (c) 2009 Daisuke Okanohara All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "queryProfile.hpp"
+
+using namespace std;
+
+namespace SE{
+
+namespace {
+
+const char* stageNames[] = {"parse", "fetch", "blockDecode", "decodeDoc", "searchAND", "rank"};
+const char* counterNames[] = {"postings", "blocksDecoded", "saProbes", "bytesCompared"};
+
+}
+
+QueryProfile::QueryProfile(){
+  clear();
+}
+
+void QueryProfile::clear(){
+  for (size_t i = 0; i < STAGE_N; ++i){
+    times[i] = 0.0;
+  }
+  for (size_t i = 0; i < COUNTER_N; ++i){
+    counts[i] = 0;
+  }
+  candidates.clear();
+}
+
+void QueryProfile::addCandidates(const size_t step, const uint64_t n){
+  if (candidates.size() <= step){
+    candidates.resize(step + 1, 0);
+  }
+  candidates[step] += n;
+}
+
+void QueryProfile::add(const QueryProfile& prof){
+  for (size_t i = 0; i < STAGE_N; ++i){
+    times[i] += prof.times[i];
+  }
+  for (size_t i = 0; i < COUNTER_N; ++i){
+    counts[i] += prof.counts[i];
+  }
+  for (size_t i = 0; i < prof.candidates.size(); ++i){
+    addCandidates(i, prof.candidates[i]);
+  }
+}
+
+void QueryProfile::print(ostream& os, const size_t queryN) const{
+  const double n = (queryN > 0) ? static_cast<double>(queryN) : 1.0;
+  os << "profile:";
+  for (size_t i = 0; i < STAGE_N; ++i){
+    os << " " << stageNames[i] << " " << times[i] * 1000 / n;
+  }
+  os << " (milli seconds)" << endl;
+  os << "counter:";
+  for (size_t i = 0; i < COUNTER_N; ++i){
+    os << " " << counterNames[i] << " " << counts[i] / n;
+  }
+  os << " candidates";
+  if (candidates.empty()) os << " -";
+  for (size_t i = 0; i < candidates.size(); ++i){
+    os << ((i == 0) ? " " : ",") << candidates[i] / n;
+  }
+  os << endl;
+}
+
+const char* QueryProfile::getStageName(const Stage stage){
+  return stageNames[stage];
+}
+
+const char* QueryProfile::getCounterName(const Counter counter){
+  return counterNames[counter];
+}
+
+}
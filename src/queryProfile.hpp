@@ -0,0 +1,136 @@
+/*
+ * queryProfile.hpp
+ * Copyright (c) 2009 Daisuke Okanohara All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef QUERY_PROFILE_HPP__
+#define QUERY_PROFILE_HPP__
+
+#include <vector>
+#include <iostream>
+#include <cstddef>
+#include <stdint.h>
+#include "timer.hpp"
+
+namespace SE{
+
+/**
+ * Stage durations and counters of queries.
+ * Searches fill it in only when it is given, so that it costs nothing otherwise.
+ * Profiles of several queries can be summed up by add().
+ */
+class QueryProfile {
+public:
+  enum Stage {
+    PARSE = 0,       ///< Parse a query into terms
+    FETCH,           ///< Find positions (posting lists, suffix array or scan)
+    BLOCK_DECODE,    ///< Decode compressed blocks (a part of FETCH)
+    DECODE_DOC,      ///< Convert positions into documents
+    SEARCH_AND,      ///< Intersect documents of terms
+    RANK,            ///< Rank documents
+    STAGE_N
+  };
+
+  enum Counter {
+    POSTINGS = 0,    ///< Positions read from posting lists
+    BLOCKS_DECODED,  ///< Compressed blocks decoded
+    SA_PROBES,       ///< Suffixes compared in binary searches of a suffix array
+    BYTES_COMPARED,  ///< Bytes of the text compared with a query
+    COUNTER_N
+  };
+
+  QueryProfile(); ///< Constructor
+
+  /**
+   * Reset all durations and counters
+   */
+  void clear();
+
+  void addTime(const Stage stage, const double sec){
+    times[stage] += sec;
+  }
+
+  void addCount(const Counter counter, const uint64_t n){
+    counts[counter] += n;
+  }
+
+  /**
+   * Record the number of candidates after an intersection step
+   * @param step The number of terms intersected so far - 1
+   * @param n The number of candidates
+   */
+  void addCandidates(const size_t step, const uint64_t n);
+
+  /**
+   * Add durations and counters of another profile
+   */
+  void add(const QueryProfile& prof);
+
+  double getTime(const Stage stage) const {
+    return times[stage];
+  }
+
+  uint64_t getCount(const Counter counter) const {
+    return counts[counter];
+  }
+
+  const std::vector<uint64_t>& getCandidates() const {
+    return candidates;
+  }
+
+  /**
+   * Print durations in milli seconds and counters divided by queryN
+   */
+  void print(std::ostream& os, const size_t queryN = 1) const;
+
+  static const char* getStageName(const Stage stage);
+  static const char* getCounterName(const Counter counter);
+
+private:
+  double times[STAGE_N];
+  uint64_t counts[COUNTER_N];
+  std::vector<uint64_t> candidates; ///< Candidates after each intersection step
+};
+
+/**
+ * Add the lifetime of the object to a stage if the profile is given
+ */
+class ProfileTimer {
+public:
+  ProfileTimer(QueryProfile* prof, const QueryProfile::Stage stage) : 
+    prof(prof), stage(stage), start(prof ? gettimeofday_sec() : 0.0) {}
+
+  ~ProfileTimer(){
+    if (prof) prof->addTime(stage, gettimeofday_sec() - start);
+  }
+
+private:
+  QueryProfile* prof;
+  const QueryProfile::Stage stage;
+  const double start;
+};
+
+}
+
+#endif // QUERY_PROFILE_HPP__
@@ -24,22 +24,30 @@
  * OTHER DEALINGS IN THE SOFTWARE.
  */
 
+#include <cstring>
 #include "quickSearch.hpp"
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define MINISE_X86 1
+#endif
+
 using namespace std;
 
 namespace SE{
 
-QuickSearch::QuickSearch(){
-}
+namespace {
 
-QuickSearch::~QuickSearch(){
-}
+const size_t MIN_CHUNK = 1 << 20; ///< Bytes of the text scanned by a thread at least
 
-void QuickSearch::search(const vector<uint8_t>& query, vector<SeResult>& ret){
-  vector<uint32_t> table(0x100);
-  size_t m = query.size();
-  size_t n = text.size();
+/**
+ * QuickSearch of the query at positions [beg, end) of the text (end + m <= the text size)
+ * @return The number of bytes compared
+ */
+uint64_t scanQuick(const uint8_t* text, const size_t beg, const size_t end, 
+		   const vector<uint8_t>& query, vector<uint64_t>& hitPos){
+  uint32_t table[0x100];
+  const size_t m = query.size();
   for (size_t i = 0; i < 0x100; ++i) {
     table[i] = m+1;
   }
@@ -47,16 +55,376 @@ void QuickSearch::search(const vector<uint8_t>& query, vector<SeResult>& ret){
     table[query[i]] = m-i;
   }
 
-  vector<uint32_t> hitPos;
-  for (size_t i = 0; i+m < n; ){
+  uint64_t compared = 0;
+  for (size_t i = beg; i < end; ){
     size_t j = 0;
-    while (query[j] == text[i+j]) ++j;
+    while (j < m && query[j] == text[i+j]) ++j;
+    compared += (j < m) ? j + 1 : j;
     if (j == m) {
       hitPos.push_back(i);
     }
     i += table[text[i+m]];
   }
-  decodeDoc(hitPos, ret);
+  return compared;
+}
+
+/// Verify candidates at i + (each bit set in mask) whose first and last bytes match
+inline uint64_t verify(const uint8_t* text, const size_t i, unsigned int mask, 
+		       const vector<uint8_t>& query, vector<uint64_t>& hitPos){
+  const size_t m = query.size();
+  uint64_t compared = 0;
+  while (mask){
+    const size_t pos = i + __builtin_ctz(mask);
+    compared += m;
+    if (m <= 2 || memcmp(text + pos + 1, &query[1], m - 2) == 0){
+      hitPos.push_back(pos);
+    }
+    mask &= mask - 1;
+  }
+  return compared;
+}
+
+/// The end of candidates of a term of m bytes in [0, end) of the text of size bytes
+inline size_t termEnd(const size_t end, const size_t size, const size_t m){
+  return (size > m) ? min(end, size - m) : 0;
+}
+
+/**
+ * QuickSearch of each term one by one at positions [beg, end) of the text of size bytes
+ * @return The number of bytes compared
+ */
+uint64_t scanEach(const uint8_t* text, const size_t beg, const size_t end, const size_t size,
+		  const vector<vector<uint8_t> >& terms, vector<vector<uint64_t> >& hitPos){
+  uint64_t compared = 0;
+  for (size_t t = 0; t < terms.size(); ++t){
+    compared += scanQuick(text, beg, termEnd(end, size, terms[t].size()), terms[t], hitPos[t]);
+  }
+  return compared;
+}
+
+/**
+ * Buckets of terms for a multi-pattern filter (Teddy).
+ * A term in the bucket b sets the bit b of nibble tables of its bytes at 0 and off,
+ * so that a position may match some term of the bucket b only if the tables of 
+ * the nibbles of its two bytes all have the bit b.
+ */
+struct TermFilter {
+  enum {
+    BUCKETN = 8
+  };
+
+  explicit TermFilter(const vector<vector<uint8_t> >& terms) : off(0) {
+    memset(lo0, 0, sizeof(lo0));
+    memset(hi0, 0, sizeof(hi0));
+    memset(lo1, 0, sizeof(lo1));
+    memset(hi1, 0, sizeof(hi1));
+    off = terms[0].size() - 1;
+    for (size_t t = 1; t < terms.size(); ++t){
+      off = min(off, terms[t].size() - 1);
+    }
+    for (size_t t = 0; t < terms.size(); ++t){
+      const uint8_t bit = static_cast<uint8_t>(1U << (t % BUCKETN));
+      lo0[terms[t][0] & 0xF]   |= bit;
+      hi0[terms[t][0] >> 4]    |= bit;
+      lo1[terms[t][off] & 0xF] |= bit;
+      hi1[terms[t][off] >> 4]  |= bit;
+      buckets[t % BUCKETN].push_back(t);
+    }
+  }
+
+  uint8_t lo0[16]; ///< Buckets of the low nibble of the first byte
+  uint8_t hi0[16]; ///< Buckets of the high nibble of the first byte
+  uint8_t lo1[16]; ///< Buckets of the low nibble of the byte at off
+  uint8_t hi1[16]; ///< Buckets of the high nibble of the byte at off
+  size_t off;      ///< The last byte of the shortest term
+  vector<size_t> buckets[BUCKETN]; ///< Terms in each bucket
+};
+
+/// Verify terms in buckets of candidates at i + (each bit set in mask)
+inline uint64_t verifyBuckets(const uint8_t* text, const size_t i, unsigned int mask, 
+			      const uint8_t* bits, const vector<vector<uint8_t> >& terms, 
+			      const TermFilter& filter, vector<vector<uint64_t> >& hitPos){
+  uint64_t compared = 0;
+  while (mask){
+    const size_t j = __builtin_ctz(mask);
+    for (unsigned int b = bits[j]; b; b &= b - 1){
+      const vector<size_t>& bucket = filter.buckets[__builtin_ctz(b)];
+      for (size_t k = 0; k < bucket.size(); ++k){
+	const vector<uint8_t>& term = terms[bucket[k]];
+	compared += term.size();
+	if (memcmp(text + i + j, &term[0], term.size()) == 0){
+	  hitPos[bucket[k]].push_back(i + j);
+	}
+      }
+    }
+    mask &= mask - 1;
+  }
+  return compared;
+}
+
+#ifdef MINISE_X86
+
+// A block of the text is loaded once, and compared with the first and last bytes of all terms.
+
+__attribute__((target("sse2")))
+uint64_t scanSSE2(const uint8_t* text, const size_t beg, const size_t end, const size_t size,
+		  const vector<vector<uint8_t> >& terms, vector<vector<uint64_t> >& hitPos){
+  size_t blockEnd = end; // Blocks have candidates of all terms
+  for (size_t t = 0; t < terms.size(); ++t){
+    blockEnd = min(blockEnd, termEnd(end, size, terms[t].size()));
+  }
+  uint64_t compared = 0;
+  size_t i = beg;
+  for (; i + 16 <= blockEnd; i += 16){
+    const __m128i a = _mm_loadu_si128((const __m128i*)(text + i));
+    for (size_t t = 0; t < terms.size(); ++t){
+      const vector<uint8_t>& term = terms[t];
+      const size_t m = term.size();
+      const __m128i first = _mm_set1_epi8(static_cast<char>(term[0]));
+      const __m128i last  = _mm_set1_epi8(static_cast<char>(term[m-1]));
+      const __m128i b = _mm_loadu_si128((const __m128i*)(text + i + m - 1));
+      const unsigned int mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, first),
+								_mm_cmpeq_epi8(b, last)));
+      if (mask) compared += verify(text, i, mask, term, hitPos[t]);
+    }
+  }
+  return compared + scanEach(text, i, end, size, terms, hitPos);
+}
+
+__attribute__((target("avx2")))
+uint64_t scanAVX2(const uint8_t* text, const size_t beg, const size_t end, const size_t size,
+		  const vector<vector<uint8_t> >& terms, vector<vector<uint64_t> >& hitPos){
+  size_t blockEnd = end;
+  for (size_t t = 0; t < terms.size(); ++t){
+    blockEnd = min(blockEnd, termEnd(end, size, terms[t].size()));
+  }
+  uint64_t compared = 0;
+  size_t i = beg;
+  for (; i + 32 <= blockEnd; i += 32){
+    const __m256i a = _mm256_loadu_si256((const __m256i*)(text + i));
+    for (size_t t = 0; t < terms.size(); ++t){
+      const vector<uint8_t>& term = terms[t];
+      const size_t m = term.size();
+      const __m256i first = _mm256_set1_epi8(static_cast<char>(term[0]));
+      const __m256i last  = _mm256_set1_epi8(static_cast<char>(term[m-1]));
+      const __m256i b = _mm256_loadu_si256((const __m256i*)(text + i + m - 1));
+      const unsigned int mask = _mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(a, first),
+								      _mm256_cmpeq_epi8(b, last)));
+      if (mask) compared += verify(text, i, mask, term, hitPos[t]);
+    }
+  }
+  return compared + scanSSE2(text, i, end, size, terms, hitPos);
+}
+
+// Buckets of positions in a block are looked up by nibbles with (v)pshufb regardless of the number of terms.
+
+__attribute__((target("ssse3")))
+uint64_t scanTeddySSSE3(const uint8_t* text, const size_t beg, const size_t end, const size_t size,
+			const vector<vector<uint8_t> >& terms, const TermFilter& filter,
+			vector<vector<uint64_t> >& hitPos){
+  size_t blockEnd = end;
+  for (size_t t = 0; t < terms.size(); ++t){
+    blockEnd = min(blockEnd, termEnd(end, size, terms[t].size()));
+  }
+  const __m128i lo0 = _mm_loadu_si128((const __m128i*)filter.lo0);
+  const __m128i hi0 = _mm_loadu_si128((const __m128i*)filter.hi0);
+  const __m128i lo1 = _mm_loadu_si128((const __m128i*)filter.lo1);
+  const __m128i hi1 = _mm_loadu_si128((const __m128i*)filter.hi1);
+  const __m128i nibble = _mm_set1_epi8(0xF);
+  const __m128i zero = _mm_setzero_si128();
+  uint8_t bits[16];
+  uint64_t compared = 0;
+  size_t i = beg;
+  for (; i + 16 <= blockEnd; i += 16){
+    const __m128i a = _mm_loadu_si128((const __m128i*)(text + i));
+    const __m128i b = _mm_loadu_si128((const __m128i*)(text + i + filter.off));
+    const __m128i ma = _mm_and_si128(_mm_shuffle_epi8(lo0, _mm_and_si128(a, nibble)),
+				     _mm_shuffle_epi8(hi0, _mm_and_si128(_mm_srli_epi16(a, 4), nibble)));
+    const __m128i mb = _mm_and_si128(_mm_shuffle_epi8(lo1, _mm_and_si128(b, nibble)),
+				     _mm_shuffle_epi8(hi1, _mm_and_si128(_mm_srli_epi16(b, 4), nibble)));
+    const __m128i m = _mm_and_si128(ma, mb);
+    const unsigned int mask = ~_mm_movemask_epi8(_mm_cmpeq_epi8(m, zero)) & 0xFFFF;
+    if (mask){
+      _mm_storeu_si128((__m128i*)bits, m);
+      compared += verifyBuckets(text, i, mask, bits, terms, filter, hitPos);
+    }
+  }
+  return compared + scanEach(text, i, end, size, terms, hitPos);
+}
+
+__attribute__((target("avx2")))
+uint64_t scanTeddyAVX2(const uint8_t* text, const size_t beg, const size_t end, const size_t size,
+		       const vector<vector<uint8_t> >& terms, const TermFilter& filter,
+		       vector<vector<uint64_t> >& hitPos){
+  size_t blockEnd = end;
+  for (size_t t = 0; t < terms.size(); ++t){
+    blockEnd = min(blockEnd, termEnd(end, size, terms[t].size()));
+  }
+  // vpshufb looks up each 128 bit lane, so tables are repeated in both lanes
+  const __m256i lo0 = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)filter.lo0));
+  const __m256i hi0 = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)filter.hi0));
+  const __m256i lo1 = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)filter.lo1));
+  const __m256i hi1 = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)filter.hi1));
+  const __m256i nibble = _mm256_set1_epi8(0xF);
+  const __m256i zero = _mm256_setzero_si256();
+  uint8_t bits[32];
+  uint64_t compared = 0;
+  size_t i = beg;
+  for (; i + 32 <= blockEnd; i += 32){
+    const __m256i a = _mm256_loadu_si256((const __m256i*)(text + i));
+    const __m256i b = _mm256_loadu_si256((const __m256i*)(text + i + filter.off));
+    const __m256i ma = _mm256_and_si256(_mm256_shuffle_epi8(lo0, _mm256_and_si256(a, nibble)),
+					_mm256_shuffle_epi8(hi0, _mm256_and_si256(_mm256_srli_epi16(a, 4), nibble)));
+    const __m256i mb = _mm256_and_si256(_mm256_shuffle_epi8(lo1, _mm256_and_si256(b, nibble)),
+					_mm256_shuffle_epi8(hi1, _mm256_and_si256(_mm256_srli_epi16(b, 4), nibble)));
+    const __m256i m = _mm256_and_si256(ma, mb);
+    const unsigned int mask = ~static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(m, zero)));
+    if (mask){
+      _mm256_storeu_si256((__m256i*)bits, m);
+      compared += verifyBuckets(text, i, mask, bits, terms, filter, hitPos);
+    }
+  }
+  return compared + scanTeddySSSE3(text, i, end, size, terms, filter, hitPos);
+}
+
+bool hasAVX2(){
+  static const bool ret = __builtin_cpu_supports("avx2");
+  return ret;
+}
+
+bool hasSSSE3(){
+  static const bool ret = __builtin_cpu_supports("ssse3");
+  return ret;
+}
+
+bool hasSSE2(){
+  static const bool ret = __builtin_cpu_supports("sse2");
+  return ret;
+}
+
+#endif
+
+/**
+ * Find all terms at positions [beg, end) of the text of size bytes in one pass.
+ * A match may end beyond end, so that a chunk finds matches crossing its end.
+ * Several terms are filtered by buckets (Teddy) with SSSE3 or AVX2, and
+ * by their first and last bytes with SSE2. Without SIMD, terms are searched one by one.
+ * @return The number of bytes compared
+ */
+uint64_t scanText(const uint8_t* text, const size_t beg, const size_t end, const size_t size,
+		  const vector<vector<uint8_t> >& terms, vector<vector<uint64_t> >& hitPos){
+#ifdef MINISE_X86
+  bool hasEmpty = false;
+  for (size_t t = 0; t < terms.size(); ++t){
+    if (terms[t].empty()) hasEmpty = true;
+  }
+  if (!hasEmpty && terms.size() > 1 && (hasAVX2() || hasSSSE3())){
+    const TermFilter filter(terms);
+    if (hasAVX2()){
+      return scanTeddyAVX2(text, beg, end, size, terms, filter, hitPos);
+    } else {
+      return scanTeddySSSE3(text, beg, end, size, terms, filter, hitPos);
+    }
+  }
+  if (!hasEmpty){
+    if (hasAVX2()){
+      return scanAVX2(text, beg, end, size, terms, hitPos);
+    } else if (hasSSE2()){
+      return scanSSE2(text, beg, end, size, terms, hitPos);
+    }
+  }
+#endif
+  return scanEach(text, beg, end, size, terms, hitPos);
+}
+
+/// Scan chunks of the text by threads and keep hits of each chunk
+class ScanTask : public ParallelTask {
+public:
+  ScanTask(const uint8_t* text, const size_t size, const vector<vector<uint8_t> >& terms, 
+	   const int chunkN) :
+    text(text), size(size), terms(terms), 
+    hitPos(chunkN, vector<vector<uint64_t> >(terms.size())), compared(chunkN, 0) {}
+
+  void run(const int chunkID){
+    const size_t chunkN = hitPos.size();
+    const size_t beg = size * chunkID / chunkN;
+    const size_t end = size * (chunkID + 1) / chunkN;
+    compared[chunkID] = scanText(text, beg, end, size, terms, hitPos[chunkID]);
+  }
+
+  /// Hits of each term in all chunks in increasing order
+  void getHits(vector<vector<uint64_t> >& ret) const {
+    for (size_t t = 0; t < terms.size(); ++t){
+      for (size_t i = 0; i < hitPos.size(); ++i){
+	ret[t].insert(ret[t].end(), hitPos[i][t].begin(), hitPos[i][t].end());
+      }
+    }
+  }
+
+  uint64_t getCompared() const {
+    uint64_t ret = 0;
+    for (size_t i = 0; i < compared.size(); ++i){
+      ret += compared[i];
+    }
+    return ret;
+  }
+
+private:
+  const uint8_t* text;
+  const size_t size;
+  const vector<vector<uint8_t> >& terms;
+  vector<vector<vector<uint64_t> > > hitPos; ///< Hits of each term in each chunk
+  vector<uint64_t> compared;
+};
+
+}
+
+QuickSearch::QuickSearch() : threadN(1) {
+}
+
+QuickSearch::~QuickSearch(){
+}
+
+void QuickSearch::search(const vector<uint8_t>& query, ResultSet& ret, QueryProfile* prof){
+  vector<vector<uint8_t> > terms(1, query);
+  vector<ResultSet> rets;
+  searchTerms(terms, rets, prof);
+  ret.swap(rets[0]);
+}
+
+void QuickSearch::searchTerms(const vector<vector<uint8_t> >& terms, vector<ResultSet>& rets, 
+			      QueryProfile* prof){
+  if (rets.size() < terms.size()) rets.resize(terms.size());
+  vector<vector<uint64_t> > hitPos(terms.size());
+  {
+    ProfileTimer timer(prof, QueryProfile::FETCH);
+    const size_t n = text.size();
+    uint64_t compared = 0;
+    if (threadN > 1 && n >= 2 * MIN_CHUNK){
+      const int chunkN = static_cast<int>(min(static_cast<size_t>(threadN), n / MIN_CHUNK));
+      ScanTask task(text.begin(), n, terms, chunkN);
+      pool.run(task, chunkN);
+      task.getHits(hitPos);
+      compared = task.getCompared();
+    } else {
+      compared = scanText(text.begin(), 0, n, n, terms, hitPos);
+    }
+    if (prof) prof->addCount(QueryProfile::BYTES_COMPARED, compared);
+  }
+  for (size_t t = 0; t < terms.size(); ++t){
+    rets[t].clear();
+    decodeDoc(hitPos[t], rets[t], prof);
+  }
+}
+
+int QuickSearch::setThreadN(const int threadN_){
+  threadN = threadN_;
+  // The calling thread also scans a chunk
+  if (threadN - 1 > pool.getThreadN() && pool.start(threadN - 1 - pool.getThreadN()) == -1){
+    what_ << "cannot create threads";
+    return -1;
+  }
+  return 0;
 }
 
 int QuickSearch::save(const char* index){
@@ -75,22 +443,21 @@ int QuickSearch::save(const char* index){
 }
 
 int QuickSearch::load(const char* index){
-  ifstream ifs(index);
-  if (!ifs){
+  if (indexFile.open(index) == -1){
     what_ << "cannot open " << index;
     return -1;
   }
   int indexType = -1;
-  if (read(indexType, "indexType", ifs) == -1) return -1;
+  if (read(indexType, "indexType", indexFile) == -1) return -1;
   if (indexType != QUICKSEARCH){
     what_ << "indexType is not QUICKSEARCH:" << indexType;
     return -1;
   }
 
 
-  if (read(text, "text", ifs) == -1) return -1;
-  if (read(docOffsets, "docOffsets", ifs) == -1) return -1;
-  if (read(titles, "titles", ifs) == -1) return -1;
+  if (read(text, "text", indexFile) == -1) return -1;
+  if (read(docOffsets, "docOffsets", indexFile) == -1) return -1;
+  if (read(titles, "titles", indexFile) == -1) return -1;
 
   docN = static_cast<uint32_t>(docOffsets.size())-1;
   return 0;
@@ -99,6 +466,10 @@ int QuickSearch::load(const char* index){
 void QuickSearch::addIndex(const std::vector<uint8_t>& content){
 }
 
+Minise* QuickSearch::createPart() const{
+  return new QuickSearch;
+}
+
 int QuickSearch::build(){
   return 0;
 }
@@ -28,11 +28,15 @@
 #define QUICK_SEARCH_HPP__
 
 #include "miniseBase.hpp"
+#include "parallel.hpp"
 
 namespace SE{
 
 /**
- * Sequential Search by QuickSearch)
+ * Sequential Search by QuickSearch.
+ * Candidates whose first and last bytes match a query are found by AVX2 or SSE2 
+ * if the CPU supports it, and the text is scanned by chunks in parallel by setThreadN().
+ * All terms of a query are found in one scan.
  */
 class QuickSearch : public Minise {
 public:
@@ -42,13 +46,26 @@ public:
   int save(const char* index); ///< Save current index to the file (text itself)
   int load(const char* index); ///< Save current index to the file (text itself)
   void addIndex(const std::vector<uint8_t>& content); ///< Do nothing
+  Minise* createPart() const;
   int build();
 
+  /**
+   * Scan the text of a query by several threads (not saved)
+   * @param threadN The number of threads
+   * @return Return 0 if it succeded or -1 if failed to create threads
+   */
+  int setThreadN(const int threadN);
+
   std::string getIndexName() const;
   size_t getIndexSize() const;
 
 private:
-  void search(const std::vector<uint8_t>& query, std::vector<SeResult>& ret);
+  void search(const std::vector<uint8_t>& query, ResultSet& ret, QueryProfile* prof);
+  void searchTerms(const std::vector<std::vector<uint8_t> >& terms, 
+		   std::vector<ResultSet>& rets, QueryProfile* prof); ///< Find all terms in one scan
+
+  int threadN;     ///< The number of threads to scan the text
+  ThreadPool pool; ///< Workers to scan chunks of the text
 };
 
 }
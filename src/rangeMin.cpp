@@ -0,0 +1,126 @@
+/*
+ * rangeMin.cpp
+ * Copyright (c) 2009 Daisuke Okanohara All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cstring>
+#include "rangeMin.hpp"
+
+using namespace std;
+
+namespace SE{
+
+namespace {
+
+/// floor(log2(x)) for x > 0
+inline size_t log2Floor(const uint64_t x){
+  return 63 - __builtin_clzll(x);
+}
+
+}
+
+RangeMin::RangeMin() : blockN(0) {
+}
+
+RangeMin::~RangeMin(){
+}
+
+void RangeMin::build(vector<uint32_t>& values_){
+  values.swap(values_);
+  table.clear();
+  const size_t n = values.size();
+  blockN = (n + BLOCK - 1) / BLOCK;
+  if (blockN == 0) return;
+
+  const size_t levelN = log2Floor(blockN) + 1;
+  table.resize(levelN * blockN);
+  uint32_t* levels = table.writable();
+  for (size_t j = 0; j < blockN; ++j){
+    levels[j] = static_cast<uint32_t>(scan(j * BLOCK, min(n, (j + 1) * BLOCK)));
+  }
+  for (size_t k = 1; k < levelN; ++k){
+    const uint32_t* prev = levels + (k - 1) * blockN;
+    uint32_t* cur = levels + k * blockN;
+    const size_t half = 1ULL << (k - 1);
+    for (size_t j = 0; j < blockN; ++j){
+      if (j + half >= blockN){
+	cur[j] = prev[j]; // Not used
+	continue;
+      }
+      const uint32_t a = prev[j];
+      const uint32_t b = prev[j + half];
+      cur[j] = (values[b] < values[a]) ? b : a;
+    }
+  }
+}
+
+size_t RangeMin::scan(const size_t beg, const size_t end) const{
+  size_t ret = beg;
+  for (size_t i = beg + 1; i < end; ++i){
+    if (values[i] < values[ret]) ret = i;
+  }
+  return ret;
+}
+
+size_t RangeMin::argmin(const size_t beg, const size_t end) const{
+  const size_t bb = beg / BLOCK;
+  const size_t eb = (end - 1) / BLOCK;
+  if (bb == eb) return scan(beg, end);
+
+  size_t ret = scan(beg, (bb + 1) * BLOCK);
+  if (bb + 1 < eb){
+    // Blocks [bb+1, eb) are covered by two overlapping ranges of 2^k blocks
+    const size_t k = log2Floor(eb - bb - 1);
+    const uint32_t* level = table.begin() + k * blockN;
+    const size_t a = level[bb + 1];
+    const size_t b = level[eb - (1ULL << k)];
+    if (values[a] < values[ret]) ret = a;
+    if (values[b] < values[ret]) ret = b;
+  }
+  const size_t last = scan(eb * BLOCK, end);
+  if (values[last] < values[ret]) ret = last;
+  return ret;
+}
+
+size_t RangeMin::getSize() const{
+  return values.size() * sizeof(uint32_t) + table.size() * sizeof(uint32_t);
+}
+
+int RangeMin::save(ofstream& ofs) const{
+  if (!ofs.write((const char*)(&blockN), sizeof(blockN))) return -1;
+  if (values.save(ofs) == -1) return -1;
+  if (table.save(ofs) == -1) return -1;
+  return 0;
+}
+
+int RangeMin::load(MappedFile& mf){
+  const uint8_t* p = mf.get(sizeof(blockN), 1);
+  if (p == NULL) return -1;
+  memcpy(&blockN, p, sizeof(blockN));
+  if (values.load(mf) == -1) return -1;
+  if (table.load(mf) == -1) return -1;
+  return 0;
+}
+
+}
@@ -0,0 +1,100 @@
+/*
+ * rangeMin.hpp
+ * Copyright (c) 2009 Daisuke Okanohara All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef RANGE_MIN_HPP__
+#define RANGE_MIN_HPP__
+
+#include <vector>
+#include <fstream>
+#include <stdint.h>
+#include "mappedFile.hpp"
+#include "mappedVector.hpp"
+
+namespace SE{
+
+/**
+ * Range minimum queries over an array of 32-bit values.
+ * The array is divided into blocks of BLOCK values, and a sparse table keeps
+ * the position of the minimum in every 2^k consecutive blocks, so that a query
+ * scans at most two partial blocks and looks up two entries of the table.
+ * The table takes about log(n/BLOCK)/BLOCK words for each value.
+ */
+class RangeMin {
+public:
+  RangeMin(); ///< Constructor
+  ~RangeMin(); ///< Destructor
+
+  /**
+   * Build the table for values
+   * @param values Values (less than 2^32), swapped into the object
+   */
+  void build(std::vector<uint32_t>& values);
+
+  /**
+   * @param i A position
+   * @return The i-th value
+   */
+  uint32_t operator[](const size_t i) const {
+    return values[i];
+  }
+
+  /**
+   * @param beg The beginning of a range
+   * @param end The end of a range (beg < end)
+   * @return A position of the minimum value in [beg, end)
+   */
+  size_t argmin(const size_t beg, const size_t end) const;
+
+  /**
+   * @return The number of values
+   */
+  size_t size() const {
+    return values.size();
+  }
+
+  /**
+   * @return The number of bytes used
+   */
+  size_t getSize() const;
+
+  int save(std::ofstream& ofs) const;
+  int load(MappedFile& mf);
+
+private:
+  enum {
+    BLOCK = 128 ///< Values in a block
+  };
+
+  size_t scan(const size_t beg, const size_t end) const; ///< The minimum in [beg, end) by a linear scan
+
+  MappedVector<uint32_t> values;
+  MappedVector<uint32_t> table; ///< table[k * blockN + j] is the minimum of blocks [j, j+2^k)
+  uint64_t blockN;
+};
+
+}
+
+#endif // RANGE_MIN_HPP__
@@ -0,0 +1,102 @@
+/*
+ * resultSet.cpp
+ * Copyright (c) 2009 Daisuke Okanohara All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <algorithm>
+#include "resultSet.hpp"
+
+using namespace std;
+
+namespace SE{
+
+ResultSet::ResultSet() : bounds(1, 0) {
+}
+
+void ResultSet::clear(){
+  docIDs.clear();
+  bounds.resize(1);
+  offsets.clear();
+  scores.clear();
+}
+
+void ResultSet::setScore(const size_t i, const double score){
+  if (scores.size() < docIDs.size()){
+    scores.resize(docIDs.size(), 0.0);
+  }
+  scores[i] = score;
+}
+
+size_t ResultSet::lowerBound(const uint32_t docID, const size_t beg) const{
+  return lower_bound(docIDs.begin() + beg, docIDs.end(), docID) - docIDs.begin();
+}
+
+void ResultSet::addDoc(const ResultSet& rs, const size_t i, const uint32_t docID){
+  addDoc(docID);
+  const uint32_t* p = rs.getOffsets(i);
+  addOffsets(p, p + rs.getOffsetN(i));
+  if (i < rs.scores.size()){
+    setScore(size() - 1, rs.scores[i]);
+  }
+}
+
+namespace {
+
+class CompByOffsetN{
+public:
+  CompByOffsetN(const vector<uint32_t>& bounds) : bounds(bounds) {}
+  bool operator () (const uint32_t i1, const uint32_t i2) const{
+    return bounds[i1+1] - bounds[i1] < bounds[i2+1] - bounds[i2];
+  }
+private:
+  const vector<uint32_t>& bounds;
+};
+
+}
+
+void ResultSet::rankByTF(){
+  vector<uint32_t> order(docIDs.size());
+  for (size_t i = 0; i < order.size(); ++i){
+    order[i] = static_cast<uint32_t>(i);
+  }
+  sort(order.rbegin(), order.rend(), CompByOffsetN(bounds));
+
+  ResultSet ranked;
+  ranked.docIDs.reserve(docIDs.size());
+  ranked.bounds.reserve(bounds.size());
+  ranked.offsets.reserve(offsets.size());
+  for (size_t i = 0; i < order.size(); ++i){
+    ranked.addDoc(*this, order[i], docIDs[order[i]]);
+  }
+  swap(ranked);
+}
+
+void ResultSet::swap(ResultSet& rs){
+  docIDs.swap(rs.docIDs);
+  bounds.swap(rs.bounds);
+  offsets.swap(rs.offsets);
+  scores.swap(rs.scores);
+}
+
+}
@@ -0,0 +1,151 @@
+/*
+ * resultSet.hpp
+ * Copyright (c) 2009 Daisuke Okanohara All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef RESULT_SET_HPP__
+#define RESULT_SET_HPP__
+
+#include <vector>
+#include <cstddef>
+#include <stdint.h>
+
+namespace SE{
+
+/**
+ * Compact search result.
+ * Hit documents are stored as docIDs, and their hit positions are stored
+ * in one array where the positions of the i-th document are
+ * offsets[bounds[i]...bounds[i+1]) (CSR form).
+ * clear() keeps allocated memory, so a ResultSet can be reused for many queries.
+ */
+class ResultSet {
+public:
+  ResultSet(); ///< Constructor
+
+  /**
+   * Remove all documents but keep the memory for the next query
+   */
+  void clear();
+
+  /**
+   * Append a hit document. Following addOffset() calls add its positions.
+   * @param docID A document ID
+   */
+  void addDoc(const uint32_t docID){
+    docIDs.push_back(docID);
+    bounds.push_back(bounds.back());
+  }
+
+  /**
+   * Append a hit position to the last document
+   * @param offset A position in the document
+   */
+  void addOffset(const uint32_t offset){
+    offsets.push_back(offset);
+    bounds.back()++;
+  }
+
+  /**
+   * Append hit positions to the last document
+   */
+  void addOffsets(const uint32_t* beg, const uint32_t* end){
+    offsets.insert(offsets.end(), beg, end);
+    bounds.back() += static_cast<uint32_t>(end - beg);
+  }
+
+  /**
+   * @return The number of hit documents
+   */
+  size_t size() const {
+    return docIDs.size();
+  }
+
+  bool empty() const {
+    return docIDs.empty();
+  }
+
+  /**
+   * @return The total number of hit positions
+   */
+  size_t getOffsetN() const {
+    return offsets.size();
+  }
+
+  uint32_t getDocID(const size_t i) const {
+    return docIDs[i];
+  }
+
+  /**
+   * @return The number of hit positions of the i-th document
+   */
+  size_t getOffsetN(const size_t i) const {
+    return bounds[i+1] - bounds[i];
+  }
+
+  /**
+   * @return Hit positions of the i-th document
+   */
+  const uint32_t* getOffsets(const size_t i) const {
+    return offsets.empty() ? NULL : &offsets[0] + bounds[i];
+  }
+
+  /**
+   * @return A ranking score of the i-th document (0 if not ranked)
+   */
+  double getScore(const size_t i) const {
+    return (i < scores.size()) ? scores[i] : 0.0;
+  }
+
+  void setScore(const size_t i, const double score);
+
+  /**
+   * @param docID A document ID
+   * @param beg A position to start searching
+   * @return The first position i >= beg such that getDocID(i) >= docID
+   */
+  size_t lowerBound(const uint32_t docID, const size_t beg) const;
+
+  /**
+   * Append the i-th document of another result with its positions and score
+   */
+  void addDoc(const ResultSet& rs, const size_t i, const uint32_t docID);
+
+  /**
+   * Sort documents by the number of hit positions in descending order
+   */
+  void rankByTF();
+
+  void swap(ResultSet& rs);
+
+private:
+  std::vector<uint32_t> docIDs;  ///< Hit documents
+  std::vector<uint32_t> bounds;  ///< Beginning of each document's positions in offsets
+  std::vector<uint32_t> offsets; ///< Hit positions of all documents
+  std::vector<double> scores;    ///< Ranking scores (empty if not ranked)
+};
+
+}
+
+#endif // RESULT_SET_HPP__
@@ -31,13 +31,7 @@ using namespace std;
 
 namespace SE{
 
-RiceCode::RiceCode() : offset(0), bytePos(0) {}
-RiceCode::RiceCode(const vector<uint32_t>& v) : offset(0), bytePos(0) {
-  encode(v);
-}
-RiceCode::~RiceCode(){}
-
-void RiceCode::encode(const vector<uint32_t>& v){
+void RiceCode::encode(const vector<uint32_t>& v, vector<uint8_t>& out){
   if (v.size() == 0) return;
   if (v.size() == 1) return;
   uint32_t b   = (v.back() - v.front()) / (v.size()-1);
@@ -46,23 +40,27 @@ void RiceCode::encode(const vector<uint32_t>& v){
     radix++;
   }
 
-  offset = 0;
+  vector<uint32_t> B;
+  uint32_t offset = 0;
   B.push_back(v.front());
   assert(radix != 32);
   B.push_back(0);
-  putBits(1U << radix, radix + 1);
+  putBits(1U << radix, radix + 1, B, offset);
 
   for (size_t i = 1; i < v.size(); ++i){
     uint32_t dif = v[i] - v[i-1] - 1;
     uint32_t low = dif & ((1 << radix) - 1);
     uint32_t up  = dif >> radix;
 
-    setUnary(up);
-    putBits(low, radix);
+    setUnary(up, B, offset);
+    putBits(low, radix, B, offset);
   }
+
+  const uint8_t* p = reinterpret_cast<const uint8_t*>(&B[0]);
+  out.insert(out.end(), p, p + B.size() * sizeof(B[0]));
 }
 
-void RiceCode::setUnary(uint32_t x) {
+void RiceCode::setUnary(uint32_t x, vector<uint32_t>& B, uint32_t& offset) {
   offset += x;
   while (offset >= 32){
     B.push_back(0);
@@ -76,7 +74,7 @@ void RiceCode::setUnary(uint32_t x) {
 }
 
 
-void RiceCode::putBits(uint32_t x, uint32_t w){
+void RiceCode::putBits(uint32_t x, uint32_t w, vector<uint32_t>& B, uint32_t& offset){
   if (offset + w >= 32){
     B.back() |= (x << offset);
     w -= (32 - offset);
@@ -88,7 +86,7 @@ void RiceCode::putBits(uint32_t x, uint32_t w){
   offset += w;
 }
 
-uint32_t RiceCode::getBits(uint32_t w){
+uint32_t RiceCode::getBits(uint32_t w, const uint32_t* B, size_t& bytePos, uint32_t& offset){
   if (offset + w <= 32){
     uint32_t ret = (B[bytePos] >> offset) & ((1U << w) - 1);
     offset += w;
@@ -109,7 +107,7 @@ uint32_t RiceCode::getBits(uint32_t w){
   }
 }
 
-uint32_t RiceCode::getUnary() {
+uint32_t RiceCode::getUnary(const uint32_t* B, size_t& bytePos, uint32_t& offset) {
   uint32_t count = 0;
   for (;;){
     uint32_t bit = (B[bytePos] >> offset) & 1U;
@@ -124,38 +122,19 @@ uint32_t RiceCode::getUnary() {
   return count;
 }
 
-void RiceCode::decode(vector<uint32_t>& v) {
-  if (v.size() == 0) return;
+void RiceCode::decode(const uint8_t* p, const size_t size, uint32_t* v, const size_t n) {
+  if (n == 0) return;
+  const uint32_t* B = reinterpret_cast<const uint32_t*>(p);
   v[0] = B[0];
-  bytePos = 1;
-  offset = 0;
-  uint32_t radix  = getUnary();
+  size_t bytePos = 1;
+  uint32_t offset = 0;
+  uint32_t radix  = getUnary(B, bytePos, offset);
 
-  for (size_t i = 1; i < v.size(); ++i){
-    uint32_t up  = getUnary();
-    uint32_t low = getBits(radix);
+  for (size_t i = 1; i < n; ++i){
+    uint32_t up  = getUnary(B, bytePos, offset);
+    uint32_t low = getBits(radix, B, bytePos, offset);
     v[i] = (up << radix) + low + v[i-1] + 1;
   }
 }
 
-size_t RiceCode::size() const{
-  return B.size() * sizeof(B[0]);
-}
-
-int RiceCode::save(ofstream& ofs) const{
-  uint32_t size = static_cast<uint32_t>(B.size());
-  if (!ofs.write((const char*)(&size), sizeof(size))) return -1;
-  if (size == 0) return 0;
-  if (!ofs.write((const char*)(&B[0]), sizeof(B[0]) * B.size())) return -1;
-  return 0;
-}
-  
-int RiceCode::load(ifstream& ifs) {
-  uint32_t size = 0;
-  if (!ifs.read((char*)(&size), sizeof(size))) return -1;
-  B.resize(size);
-  if (!ifs.read((char*)(&B[0]), sizeof(B[0]) * size)) return -1;
-  return 0;
-}
-
 }
@@ -27,34 +27,32 @@
 #ifndef RICE_CODE_HPP__
 #define RICE_CODE_HPP__
 
-#include "compressedBlock.hpp"
+#include <vector>
+#include <cstddef>
+#include <stdint.h>
 
 namespace SE{
 
 /**
  * Rice Code
  */
-class RiceCode : public CompressedBlock {
+class RiceCode {
 public:
-  RiceCode(); ///< Constructor
-  RiceCode(const std::vector<uint32_t>& v);
-  ~RiceCode(); ///< Destructor
+  /**
+   * Append the code of v to out (for blocks in an arena, aligned to 4 bytes)
+   */
+  static void encode(const std::vector<uint32_t>& v, std::vector<uint8_t>& out);
 
-  void encode(const std::vector<uint32_t>& v);
-  void decode(std::vector<uint32_t>& v);
-  size_t size() const;
-
-  int save(std::ofstream& ofs) const;
-  int load(std::ifstream& ifs);
+  /**
+   * Decode n positions from the code p of size bytes (aligned to 4 bytes)
+   */
+  static void decode(const uint8_t* p, const size_t size, uint32_t* v, const size_t n);
 
 private:
-  void setUnary(uint32_t x);
-  void  putBits(uint32_t x, uint32_t w);
-  uint32_t getBits(uint32_t w);
-  uint32_t getUnary();
-  uint32_t offset;
-  uint32_t bytePos;
-  std::vector<uint32_t> B;
+  static void setUnary(uint32_t x, std::vector<uint32_t>& B, uint32_t& offset);
+  static void  putBits(uint32_t x, uint32_t w, std::vector<uint32_t>& B, uint32_t& offset);
+  static uint32_t getBits(uint32_t w, const uint32_t* B, size_t& bytePos, uint32_t& offset);
+  static uint32_t getUnary(const uint32_t* B, size_t& bytePos, uint32_t& offset);
 };
 
 }
@@ -0,0 +1,415 @@
+/*
+ * shardedMinise.cpp
+ * Copyright (c) 2009 Daisuke Okanohara All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <queue>
+#include <functional>
+#include "shardedMinise.hpp"
+#include "invertedFile.hpp"
+#include "suffixArray.hpp"
+#include "fmIndex.hpp"
+#include "quickSearch.hpp"
+
+using namespace std;
+
+namespace SE{
+
+namespace {
+
+Minise* newShard(const Minise::IndexType indexType){
+  if (indexType == Minise::QUICKSEARCH){
+    return new QuickSearch;
+  } else if (indexType == Minise::ONEGRAM ||
+	     indexType == Minise::TWOGRAM ||
+	     indexType == Minise::INVERTEDFILE){
+    return new InvertedFile;
+  } else if (indexType == Minise::SUFFIXARRAY ||
+	     indexType == Minise::SUFFIXARRAY_UTF8){
+    return new SuffixArray;
+  } else if (indexType == Minise::FMINDEX){
+    return new FMIndex;
+  } else {
+    return NULL;
+  }
+}
+
+class SearchTask : public ParallelTask {
+public:
+  SearchTask(const vector<Minise*>& shards, const string& query, const bool useProfile) :
+    shards(shards), query(query), rets(shards.size()), 
+    profs(useProfile ? shards.size() : 0) {}
+
+  void run(const int shardID){
+    shards[shardID]->search(query.c_str(), query.size(), rets[shardID], 
+			    profs.empty() ? NULL : &profs[shardID]);
+  }
+
+  const vector<ResultSet>& getResults() const {
+    return rets;
+  }
+
+  const vector<QueryProfile>& getProfiles() const {
+    return profs;
+  }
+
+private:
+  const vector<Minise*>& shards;
+  const string& query;
+  vector<ResultSet> rets;
+  vector<QueryProfile> profs;
+};
+
+class ListTask : public ParallelTask {
+public:
+  ListTask(const vector<Minise*>& shards, const string& query, const bool useCounts, const bool useProfile) :
+    shards(shards), query(query), docIDs(shards.size()), counts(useCounts ? shards.size() : 0),
+    profs(useProfile ? shards.size() : 0) {}
+
+  void run(const int shardID){
+    shards[shardID]->listDocs(query.c_str(), query.size(), docIDs[shardID], 
+			      counts.empty() ? NULL : &counts[shardID],
+			      profs.empty() ? NULL : &profs[shardID]);
+  }
+
+  const vector<vector<uint32_t> >& getDocIDs() const {
+    return docIDs;
+  }
+
+  const vector<vector<uint32_t> >& getCounts() const {
+    return counts;
+  }
+
+  const vector<QueryProfile>& getProfiles() const {
+    return profs;
+  }
+
+private:
+  const vector<Minise*>& shards;
+  const string& query;
+  vector<vector<uint32_t> > docIDs;
+  vector<vector<uint32_t> > counts;
+  vector<QueryProfile> profs;
+};
+
+class AddFilesTask : public ParallelTask {
+public:
+  AddFilesTask(const vector<Minise*>& shards, const vector<string>& fileNames, const uint32_t docN) :
+    shards(shards), fileNames(fileNames), docN(docN), failed(shards.size(), 0) {}
+
+  void run(const int shardID){
+    for (size_t i = 0; i < fileNames.size(); ++i){
+      if ((docN + i) % shards.size() != static_cast<size_t>(shardID)) continue;
+      if (shards[shardID]->addFile(fileNames[i].c_str()) == -1){
+	failed[shardID] = 1;
+	return;
+      }
+    }
+  }
+
+  bool isFailed(const size_t shardID) const {
+    return failed[shardID] != 0;
+  }
+
+private:
+  const vector<Minise*>& shards;
+  const vector<string>& fileNames;
+  const uint32_t docN;
+  vector<char> failed;
+};
+
+class BuildTask : public ParallelTask {
+public:
+  BuildTask(const vector<Minise*>& shards) : shards(shards), failed(shards.size(), 0) {}
+
+  void run(const int shardID){
+    if (shards[shardID]->build() == -1){
+      failed[shardID] = 1;
+    }
+  }
+
+  bool isFailed(const size_t shardID) const {
+    return failed[shardID] != 0;
+  }
+
+private:
+  const vector<Minise*>& shards;
+  vector<char> failed;
+};
+
+}
+
+ShardedMinise::ShardedMinise(){
+}
+
+ShardedMinise::ShardedMinise(const vector<Minise*>& shards) : shards(shards) {
+  // run() also works by the calling thread only, so failures can be ignored.
+  pool.start(static_cast<int>(shards.size()) - 1);
+  update();
+}
+
+ShardedMinise::~ShardedMinise(){
+  for (size_t i = 0; i < shards.size(); ++i){
+    delete shards[i];
+  }
+}
+
+void ShardedMinise::addDoc(const char* title, const vector<uint8_t>& content){
+  shards[docN % shards.size()]->addDoc(title, content);
+  update();
+}
+
+int ShardedMinise::addFiles(const vector<string>& fileNames, const int threadN){
+  if (threadN <= 1){
+    for (size_t i = 0; i < fileNames.size(); ++i){
+      if (addFile(fileNames[i].c_str()) == -1) return -1;
+    }
+    return 0;
+  }
+
+  AddFilesTask task(shards, fileNames, docN);
+  pool.run(task, static_cast<int>(shards.size()));
+  update();
+  for (size_t i = 0; i < shards.size(); ++i){
+    if (task.isFailed(i)){
+      what_ << shards[i]->what();
+      return -1;
+    }
+  }
+  return 0;
+}
+
+void ShardedMinise::addIndex(const vector<uint8_t>& content){
+  // Not used: documents are passed to shards by addDoc
+}
+
+Minise* ShardedMinise::createPart() const{
+  return NULL; // Not used: addFiles is overridden
+}
+
+/// Update the number of documents and terms from shards
+void ShardedMinise::update(){
+  docN  = 0;
+  termN = 0;
+  for (size_t i = 0; i < shards.size(); ++i){
+    docN += shards[i]->getDocN();
+    termN = max(termN, shards[i]->getTermN());
+  }
+}
+
+string ShardedMinise::quoteTerm(const vector<uint8_t>& query){
+  string query_s(query.begin(), query.end());
+  if (find_if(query.begin(), query.end(), ::isspace) != query.end()){
+    query_s = "\"" + query_s + "\""; // Shards should see a phrase as one term again
+  }
+  return query_s;
+}
+
+void ShardedMinise::search(const vector<uint8_t>& query, ResultSet& ret, QueryProfile* prof){
+  ret.clear();
+  if (shards.size() == 0) return;
+
+  const string query_s = quoteTerm(query);
+  SearchTask task(shards, query_s, prof != NULL);
+  pool.run(task, static_cast<int>(shards.size()));
+  const vector<ResultSet>& rets(task.getResults());
+  const vector<QueryProfile>& profs(task.getProfiles());
+  for (size_t i = 0; i < profs.size(); ++i){
+    prof->add(profs[i]); // Durations are summed over shards
+  }
+
+  // Merge results in order of global docIDs
+  const uint32_t shardN = static_cast<uint32_t>(shards.size());
+  typedef pair<uint32_t, size_t> Head; // (global docID, shardID)
+  priority_queue<Head, vector<Head>, greater<Head> > heads;
+  vector<size_t> pos(rets.size());
+  for (size_t i = 0; i < rets.size(); ++i){
+    if (rets[i].size() > 0){
+      heads.push(make_pair(rets[i].getDocID(0) * shardN + i, i));
+    }
+  }
+
+  while (!heads.empty()){
+    const Head h = heads.top();
+    heads.pop();
+    const size_t s = h.second;
+    ret.addDoc(rets[s], pos[s], h.first);
+    if (++pos[s] < rets[s].size()){
+      heads.push(make_pair(rets[s].getDocID(pos[s]) * shardN + s, s));
+    }
+  }
+}
+
+void ShardedMinise::listDocs(const vector<uint8_t>& query, vector<uint32_t>& docIDs, 
+			     vector<uint32_t>* counts, QueryProfile* prof){
+  if (shards.size() == 0) return;
+
+  const string query_s = quoteTerm(query);
+  ListTask task(shards, query_s, counts != NULL, prof != NULL);
+  pool.run(task, static_cast<int>(shards.size()));
+  const vector<vector<uint32_t> >& ids(task.getDocIDs());
+  const vector<QueryProfile>& profs(task.getProfiles());
+  for (size_t i = 0; i < profs.size(); ++i){
+    prof->add(profs[i]);
+  }
+
+  // Sort documents of all shards by global docIDs
+  const uint32_t shardN = static_cast<uint32_t>(shards.size());
+  vector<pair<uint32_t, uint32_t> > docs; // (global docID, count)
+  for (size_t s = 0; s < ids.size(); ++s){
+    for (size_t i = 0; i < ids[s].size(); ++i){
+      docs.push_back(make_pair(ids[s][i] * shardN + static_cast<uint32_t>(s), 
+			       counts ? task.getCounts()[s][i] : 0));
+    }
+  }
+  sort(docs.begin(), docs.end());
+  for (size_t i = 0; i < docs.size(); ++i){
+    docIDs.push_back(docs[i].first);
+    if (counts) counts->push_back(docs[i].second);
+  }
+}
+
+void ShardedMinise::getSnippet(const uint32_t docID, const int offset, 
+			       const uint32_t len, string& ret) const{
+  const uint32_t shardN = static_cast<uint32_t>(shards.size());
+  shards[docID % shardN]->getSnippet(docID / shardN, offset, len, ret);
+}
+
+const string& ShardedMinise::getTitle(const uint32_t docID) const{
+  const uint32_t shardN = static_cast<uint32_t>(shards.size());
+  return shards[docID % shardN]->getTitle(docID / shardN);
+}
+
+uint32_t ShardedMinise::getDocLength(const uint32_t docID) const{
+  const uint32_t shardN = static_cast<uint32_t>(shards.size());
+  return shards[docID % shardN]->getDocLength(docID / shardN);
+}
+
+double ShardedMinise::getAvgDocLength() const{
+  if (docN == 0) return 0.0;
+  double total = 0.0;
+  for (size_t i = 0; i < shards.size(); ++i){
+    total += shards[i]->getAvgDocLength() * shards[i]->getDocN();
+  }
+  return total / docN;
+}
+
+string ShardedMinise::shardName(const char* fileName, const size_t i){
+  ostringstream os;
+  os << fileName << "." << i;
+  return os.str();
+}
+
+int ShardedMinise::save(const char* fileName){
+  ofstream ofs(fileName);
+  if (!ofs){
+    what_ << "cannot open " << fileName;
+    return -1;
+  }
+
+  uint32_t shardN = static_cast<uint32_t>(shards.size());
+  if (write(SHARDED, "indexType", ofs) == -1) return -1;
+  if (write(shardN,  "shardN", ofs) == -1) return -1;
+
+  for (size_t i = 0; i < shards.size(); ++i){
+    if (shards[i]->save(shardName(fileName, i).c_str()) == -1){
+      what_ << shards[i]->what();
+      return -1;
+    }
+  }
+  return 0;
+}
+
+int ShardedMinise::load(const char* fileName){
+  if (indexFile.open(fileName) == -1){
+    what_ << "cannot open " << fileName;
+    return -1;
+  }
+
+  int indexType = -1;
+  uint32_t shardN = 0;
+  if (read(indexType, "indexType", indexFile) == -1) return -1;
+  if (indexType != SHARDED){
+    what_ << "indexType is not SHARDED:" << indexType;
+    return -1;
+  }
+  if (read(shardN, "shardN", indexFile) == -1) return -1;
+
+  for (uint32_t i = 0; i < shardN; ++i){
+    const string name = shardName(fileName, i);
+    IndexType shardType = QUICKSEARCH;
+    if (getIndexType(name.c_str(), shardType) == -1){
+      what_ << "cannot read " << name;
+      return -1;
+    }
+    Minise* shard = newShard(shardType);
+    if (shard == NULL){
+      what_ << "unknown indexType:" << shardType << " " << name;
+      return -1;
+    }
+    shards.push_back(shard);
+    if (shard->load(name.c_str()) == -1){
+      what_ << shard->what();
+      return -1;
+    }
+  }
+
+  pool.start(static_cast<int>(shards.size()) - 1);
+  update();
+  return 0;
+}
+
+int ShardedMinise::build(){
+  BuildTask task(shards);
+  pool.run(task, static_cast<int>(shards.size()));
+  update();
+  for (size_t i = 0; i < shards.size(); ++i){
+    if (task.isFailed(i)){
+      what_ << shards[i]->what();
+      return -1;
+    }
+  }
+  return 0;
+}
+
+string ShardedMinise::getIndexName() const{
+  ostringstream os;
+  os << "Sharded(" << shards.size() << ")";
+  if (shards.size() > 0){
+    os << " " << shards[0]->getIndexName();
+  }
+  return os.str();
+}
+
+size_t ShardedMinise::getIndexSize() const {
+  size_t ret = 0;
+  for (size_t i = 0; i < shards.size(); ++i){
+    ret += shards[i]->getIndexSize();
+  }
+  return ret;
+}
+
+}
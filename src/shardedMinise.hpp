@@ -0,0 +1,91 @@
+/*
+ * shardedMinise.hpp
+ * Copyright (c) 2009 Daisuke Okanohara All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef SHARDED_MINISE_HPP__
+#define SHARDED_MINISE_HPP__
+
+#include "miniseBase.hpp"
+#include "parallel.hpp"
+
+namespace SE{
+
+/**
+ * Index partitioned into several shards.
+ * Documents are assigned to shards in round-robin order, so the global docID
+ * of a local docID l in the s-th shard is l * shardN + s.
+ * Each shard is an index of any type and is saved to its own file.
+ * A query is searched in all shards in parallel.
+ */
+class ShardedMinise : public Minise {
+public:
+  ShardedMinise(); ///< Constructor (shards are created by load)
+
+  /**
+   * Constructor with empty shards. ShardedMinise deletes them.
+   * @param shards Empty indexes of the same type and settings
+   */
+  ShardedMinise(const std::vector<Minise*>& shards);
+  ~ShardedMinise(); ///< Destructor
+
+  void addDoc(const char* title, const std::vector<uint8_t>& content);
+  int addFiles(const std::vector<std::string>& fileNames, const int threadN); ///< Shards are filled in parallel if threadN > 1
+
+  int save(const char* fileName); ///< Save the shard list into fileName and shards into fileName.0, fileName.1, ...
+  int load(const char* fileName); ///< Load the shard list and shards
+  int build(); ///< Build shards in parallel
+
+  void getSnippet(const uint32_t docID, const int offset, 
+		  const uint32_t len, std::string& ret) const;
+  std::string getIndexName() const;
+  size_t getIndexSize() const;
+  const std::string& getTitle(const uint32_t docID) const;
+  uint32_t getDocLength(const uint32_t docID) const;
+  double getAvgDocLength() const;
+
+  /**
+   * @return The number of shards
+   */
+  uint32_t getShardN() const {
+    return static_cast<uint32_t>(shards.size());
+  }
+
+private:
+  void search(const std::vector<uint8_t>& query, ResultSet& ret, QueryProfile* prof);
+  void listDocs(const std::vector<uint8_t>& query, std::vector<uint32_t>& docIDs, 
+		std::vector<uint32_t>* counts, QueryProfile* prof);
+  static std::string quoteTerm(const std::vector<uint8_t>& query);
+  void addIndex(const std::vector<uint8_t>& content);
+  Minise* createPart() const;
+  void update();
+  static std::string shardName(const char* fileName, const size_t i);
+
+  std::vector<Minise*> shards; ///< Sub indexes
+  ThreadPool pool;             ///< Workers to search shards
+};
+
+}
+
+#endif // SHARDED_MINISE_HPP__
@@ -0,0 +1,146 @@
+/*
+ * streamVByte.cpp
+ * Copyright (c) 2009 Daisuke Okanohara All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "streamVByte.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define MINISE_X86 1
+#endif
+
+using namespace std;
+
+namespace SE{
+
+namespace {
+
+/// Shuffle masks and data lengths for each control byte
+class Tables{
+public:
+  Tables(){
+    for (int c = 0; c < 256; ++c){
+      uint8_t pos = 0;
+      for (int k = 0; k < 4; ++k){
+	const int len = ((c >> (2 * k)) & 3) + 1;
+	for (int b = 0; b < 4; ++b){
+	  shuffle[c][4 * k + b] = (b < len) ? pos + b : 0xFF; // 0xFF clears the byte
+	}
+	pos += len;
+      }
+      length[c] = pos;
+    }
+  }
+  uint8_t shuffle[256][16];
+  uint8_t length[256];
+};
+
+const Tables tables;
+
+/// Decode gaps of groups [beg, end) in scalar
+inline void decodeScalar(const uint8_t* ctrl, const uint8_t*& data, 
+			 uint32_t* v, const size_t beg, const size_t end, uint32_t& prev){
+  for (size_t i = beg; i < end; ++i){
+    const int len = ((ctrl[i / 4] >> (2 * (i % 4))) & 3) + 1;
+    uint32_t x = 0;
+    for (int b = 0; b < len; ++b){
+      x |= static_cast<uint32_t>(data[b]) << (8 * b);
+    }
+    data += len;
+    prev += x + 1;
+    v[i] = prev;
+  }
+}
+
+#ifdef MINISE_X86
+
+__attribute__((target("ssse3")))
+void decodeSSSE3(const uint8_t* ctrl, const uint8_t* data, const uint8_t* dataEnd, 
+		 uint32_t* v, const size_t n){
+  uint32_t prev = 0xFFFFFFFF; // v[0] is stored as v[0] - (-1) - 1
+  __m128i vprev = _mm_set1_epi32(-1);
+  const __m128i ones = _mm_set1_epi32(1);
+  size_t i = 0;
+  // A 16 bytes load must not go beyond the data
+  for (; i + 4 <= n && data + 16 <= dataEnd; i += 4){
+    const uint8_t c = ctrl[i / 4];
+    __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+    x = _mm_shuffle_epi8(x, _mm_loadu_si128(reinterpret_cast<const __m128i*>(tables.shuffle[c])));
+    data += tables.length[c];
+
+    x = _mm_add_epi32(x, ones);
+    x = _mm_add_epi32(x, _mm_slli_si128(x, 4));
+    x = _mm_add_epi32(x, _mm_slli_si128(x, 8));
+    x = _mm_add_epi32(x, vprev);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(v + i), x);
+    vprev = _mm_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 3, 3));
+  }
+  if (i > 0) prev = v[i-1];
+  decodeScalar(ctrl, data, v, i, n, prev);
+}
+
+bool hasSSSE3(){
+  static const bool ret = __builtin_cpu_supports("ssse3");
+  return ret;
+}
+
+#endif // MINISE_X86
+
+}
+
+void StreamVByte::encode(const vector<uint32_t>& v, vector<uint8_t>& out){
+  const size_t ctrlN = (v.size() + 3) / 4;
+  const size_t beg = out.size();
+  out.resize(beg + ctrlN, 0);
+  uint32_t prev = 0;
+  for (size_t i = 0; i < v.size(); ++i){
+    uint32_t dif = v[i] - prev;
+    prev = v[i] + 1;
+    int len = 1;
+    while (len < 4 && (dif >> (8 * len))){
+      len++;
+    }
+    out[beg + i / 4] |= static_cast<uint8_t>((len - 1) << (2 * (i % 4)));
+    for (int b = 0; b < len; ++b){
+      out.push_back(static_cast<uint8_t>(dif >> (8 * b)));
+    }
+  }
+}
+
+void StreamVByte::decode(const uint8_t* p, const size_t size, uint32_t* v, const size_t n){
+  if (n == 0) return;
+  const uint8_t* ctrl = p;
+  const uint8_t* data = ctrl + (n + 3) / 4;
+#ifdef MINISE_X86
+  if (hasSSSE3()){
+    decodeSSSE3(ctrl, data, p + size, v, n);
+    return;
+  }
+#endif
+  uint32_t prev = 0xFFFFFFFF;
+  decodeScalar(ctrl, data, v, 0, n, prev);
+}
+
+}
@@ -1,5 +1,5 @@
 /*
- * compessedBlock.hpp
+ * streamVByte.hpp
  * Copyright (c) 2009 Daisuke Okanohara All Rights Reserved.
  *
  * Permission is hereby granted, free of charge, to any person
@@ -24,30 +24,34 @@
  * OTHER DEALINGS IN THE SOFTWARE.
  */
 
-#ifndef COMPRESSED_BLOCK_HPP__
-#define COMPRESSED_BLOCK_HPP__
+#ifndef STREAM_VBYTE_HPP__
+#define STREAM_VBYTE_HPP__
 
 #include <vector>
-#include <fstream>
+#include <cstddef>
 #include <stdint.h>
 
 namespace SE{
 
 /**
- * Compressed Blcok
- * Manage Compressed Integer Sequence
+ * Stream VByte
+ * Each gap is stored in 1-4 bytes. The byte lengths are stored as 2-bit codes
+ * in control bytes separately from data bytes, so that 4 gaps are decoded
+ * by one table-driven shuffle (SSSE3 if the CPU supports it).
  */
-class CompressedBlock {
+class StreamVByte {
 public:
-  CompressedBlock(); ///< Constructor
-  virtual ~CompressedBlock(); ///< Destructor
-  virtual void encode(const std::vector<uint32_t>& v) = 0;
-  virtual void decode(std::vector<uint32_t>& v) = 0;
-  virtual size_t size() const = 0;
-  virtual int save(std::ofstream& ofs) const = 0;
-  virtual int load(std::ifstream& ifs) = 0;
+  /**
+   * Append the code of v to out (for blocks in an arena)
+   */
+  static void encode(const std::vector<uint32_t>& v, std::vector<uint8_t>& out);
+
+  /**
+   * Decode n positions from the code p of size bytes
+   */
+  static void decode(const uint8_t* p, const size_t size, uint32_t* v, const size_t n);
 };
 
 }
 
-#endif // COMPRESSED_BLOCK_HPP__
+#endif // STREAM_VBYTE_HPP__
@@ -25,78 +25,265 @@
  */
 
 #include <algorithm>
+#include <cstdio>
 #include "sais.hxx"
+#include "bitVector.hpp"
+#include "parallel.hpp"
+#include "suffixSorter.hpp"
 #include "suffixArray.hpp"
 
 using namespace std;
 
 namespace SE{
 
-static const int _popcount_table[256] = {
-  0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
-  1, 2, 2, 3, 2, 3, 3, 4, 2, 3, 3, 4, 3, 4, 4, 5,
-  1, 2, 2, 3, 2, 3, 3, 4, 2, 3, 3, 4, 3, 4, 4, 5,
-  2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6,
-  1, 2, 2, 3, 2, 3, 3, 4, 2, 3, 3, 4, 3, 4, 4, 5,
-  2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6,
-  2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6,
-  3, 4, 4, 5, 4, 5, 5, 6, 4, 5, 5, 6, 5, 6, 6, 7,
-  1, 2, 2, 3, 2, 3, 3, 4, 2, 3, 3, 4, 3, 4, 4, 5,
-  2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6,
-  2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6,
-  3, 4, 4, 5, 4, 5, 5, 6, 4, 5, 5, 6, 5, 6, 6, 7,
-  2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6,
-  3, 4, 4, 5, 4, 5, 5, 6, 4, 5, 5, 6, 5, 6, 6, 7,
-  3, 4, 4, 5, 4, 5, 5, 6, 4, 5, 5, 6, 5, 6, 6, 7,
-  4, 5, 5, 6, 5, 6, 6, 7, 5, 6, 6, 7, 6, 7, 7, 8
+namespace {
+
+/// Convert positions in SA into original positions by threadN threads
+class SelectTask : public ParallelTask {
+public:
+  SelectTask(uint32_t* SA, const size_t n, const BitVector& B, const int threadN) :
+    SA(SA), n(n), B(B), threadN(threadN) {}
+
+  void run(const int threadID){
+    const size_t end = n * (threadID + 1) / threadN;
+    for (size_t i = n * threadID / threadN; i < end; ++i){
+      SA[i] = static_cast<uint32_t>(B.select1(SA[i]));
+    }
+  }
+
+private:
+  uint32_t* SA;
+  const size_t n;
+  const BitVector& B;
+  const int threadN;
 };
 
+}
 
-SuffixArray::SuffixArray() : useUTF8(false) {
+SuffixArray::SuffixArray() : bucketLen(0), useDocList(false), threadN(1), useUTF8(false), memLimit(0) {
 }
 
 SuffixArray::~SuffixArray(){
+  if (tmpPrefix.empty()) return;
+  spool.close();
+  textFile.close();
+  saFile.close();
+  remove((tmpPrefix + ".text").c_str());
+  remove((tmpPrefix + ".sa").c_str());
+}
+
+int SuffixArray::setExternal(const string& tmpPrefix_, const size_t memLimit_){
+  tmpPrefix = tmpPrefix_;
+  memLimit  = memLimit_;
+  spool.open((tmpPrefix + ".text").c_str(), ios::binary);
+  if (!spool){
+    what_ << "cannot open " << tmpPrefix << ".text";
+    return -1;
+  }
+  return 0;
+}
+
+void SuffixArray::addDoc(const char* title, const vector<uint8_t>& content){
+  if (tmpPrefix.empty()){
+    Minise::addDoc(title, content);
+    return;
+  }
+  titles.push_back(title);
+  if (!content.empty()){
+    spool.write(reinterpret_cast<const char*>(&content[0]), content.size());
+  }
+  spool.put(0); // Guard
+  docOffsets.push_back(docOffsets.back() + content.size() + 1);
+  docN++;
+}
+
+int SuffixArray::addFiles(const vector<string>& fileNames, const int threadN_){
+  // Parts of threads would hold their texts in memory
+  return Minise::addFiles(fileNames, tmpPrefix.empty() ? threadN_ : 1);
 }
 
 void  SuffixArray::addIndex(const std::vector<uint8_t>& content){
 }
 
+Minise* SuffixArray::createPart() const{
+  return new SuffixArray;
+}
+
 void SuffixArray::setUTF8(){
   useUTF8 = true;
 }
 
+void SuffixArray::setBucketLength(const uint32_t len){
+  bucketLen = len;
+}
+
+void SuffixArray::setDocList(){
+  useDocList = true;
+}
+
+void SuffixArray::setThreadN(const int threadN_){
+  threadN = threadN_;
+}
+
 int SuffixArray::build(){
-  if (useUTF8){
-    return buildUTF8();
+  if (bucketLen > 3){
+    what_ << "bucket length should be 0-3 : " << bucketLen;
+    return -1;
   }
 
-  SA.resize(text.size()+1);
-  if (saisxx(text.begin(), SA.begin(), (int)text.size(), 0x100) != 0){
-    what_ << "saisxx error";
+  if (!tmpPrefix.empty()){
+    if (useUTF8){
+      what_ << "UTF-8 SA cannot be built out of core";
+      return -1;
+    }
+    if (buildExternal() == -1) return -1;
+  } else if (useUTF8){
+    if (checkTextSize32() == -1) return -1;
+    if (buildUTF8() == -1) return -1;
+  } else {
+    if (text.size() > 0xFFFFFFFFULL){
+      what_ << "a text over 4 GB should be built out of core : " << text.size();
+      return -1;
+    }
+    SA.resize(text.size());
+    uint32_t* sa = SA.writable();
+    if (threadN > 1 || text.size() > 0x7FFFFFFFULL){ // saisxx takes int
+      if (parallelSuffixSort(text.begin(), sa, text.size(), threadN) == -1){
+	what_ << "cannot create threads";
+	return -1;
+      }
+    } else if (saisxx(text.begin(), sa, (int)text.size(), 0x100) != 0){
+      what_ << "saisxx error";
+      return -1;
+    }
+  }
+  buildBuckets();
+  if (useDocList && buildDocList() == -1) return -1;
+  return 0;
+}
+
+int SuffixArray::buildExternal(){
+  spool.close();
+  if (spool.fail()){
+    what_ << "write error:" << tmpPrefix << ".text";
+    return -1;
+  }
+  const uint64_t n = docOffsets.back();
+  if (n == 0) return 0;
+
+  const string textName = tmpPrefix + ".text";
+  const uint8_t* p = NULL;
+  if (textFile.open(textName.c_str()) == -1 || (p = textFile.get(n, 1)) == NULL){
+    what_ << "cannot map " << textName;
+    return -1;
+  }
+  text.map(p, n);
+
+  const string saName = tmpPrefix + ".sa";
+  if (externalSuffixSort(text.begin(), n, saName.c_str(), (tmpPrefix + ".run").c_str(), memLimit) == -1){
+    what_ << "cannot sort suffixes in " << tmpPrefix;
+    return -1;
+  }
+  if (saFile.open(saName.c_str()) == -1){
+    what_ << "cannot map " << saName;
+    return -1;
+  }
+  if (n <= 0xFFFFFFFFULL){
+    p = saFile.get(n * sizeof(uint32_t), sizeof(uint32_t));
+    if (p != NULL) SA.map(reinterpret_cast<const uint32_t*>(p), n);
+  } else {
+    p = saFile.get(n * sizeof(uint64_t), sizeof(uint64_t));
+    if (p != NULL) SA64.map(reinterpret_cast<const uint64_t*>(p), n);
+  }
+  if (p == NULL){
+    what_ << "read error:" << saName;
     return -1;
   }
   return 0;
 }
 
+/// The first bucketLen bytes of p as an integer, where missing bytes are 0
+uint32_t SuffixArray::getBucket(const uint8_t* p, const size_t len) const{
+  uint32_t c = 0;
+  for (uint32_t i = 0; i < bucketLen; ++i){
+    c = (c << 8) + ((i < len) ? p[i] : 0);
+  }
+  return c;
+}
+
+void SuffixArray::buildBuckets(){
+  buckets.clear();
+  if (bucketLen == 0) return;
+
+  // Suffixes are sorted, so their first bytes are in non-decreasing order.
+  // A suffix shorter than bucketLen is padded by 0 and precedes its extensions.
+  vector<uint64_t> counts((1U << (8 * bucketLen)) + 1, 0);
+  const uint64_t saN = SA.size() + SA64.size();
+  for (uint64_t i = 0; i < saN; ++i){
+    const uint64_t pos = getSA(i);
+    counts[getBucket(text.begin() + pos, text.size() - pos) + 1]++;
+  }
+  for (size_t c = 1; c < counts.size(); ++c){
+    counts[c] += counts[c-1];
+  }
+  buckets.swap(counts);
+}
+
+uint32_t SuffixArray::getDocID(const uint64_t pos) const{
+  return static_cast<uint32_t>(upper_bound(docOffsets.begin(), docOffsets.end(), pos) - docOffsets.begin() - 1);
+}
+
+int SuffixArray::buildDocList(){
+  if (!SA64.empty()){
+    what_ << "a document list needs a text under 4 GB : " << SA64.size();
+    return -1;
+  }
+  const size_t n = SA.size();
+  vector<uint32_t> docs(n); // The document of each row
+  vector<uint32_t> offsets(docN + 1, 0);
+  for (size_t i = 0; i < n; ++i){
+    docs[i] = getDocID(SA[i]);
+    offsets[docs[i] + 1]++;
+  }
+  for (size_t d = 1; d < offsets.size(); ++d){
+    offsets[d] += offsets[d-1];
+  }
+
+  // Rows are visited in increasing order, so each list is sorted
+  vector<uint32_t> rows(n);
+  vector<uint32_t> prevs(n);
+  vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+  for (size_t i = 0; i < n; ++i){
+    const uint32_t d = docs[i];
+    prevs[i] = (fill[d] == offsets[d]) ? 0 : rows[fill[d] - 1] + 1;
+    rows[fill[d]++] = static_cast<uint32_t>(i);
+  }
+  vector<uint32_t>().swap(docs);
+  vector<uint32_t>().swap(fill);
+
+  docRows.swap(rows);
+  docRowOffsets.swap(offsets);
+  prevRows.build(prevs);
+  return 0;
+}
+
 int SuffixArray::buildUTF8(){
   bool first = true;
   size_t n = text.size();
   vector<uint32_t> T;
   uint64_t cur = 0;
 
-  vector<uint8_t> B((n + 8 - 1) / 8);
-  for (size_t i = 0; i <= text.size(); ++i){
-    if (first){
-      B[i/8] |= (1U << (i%8));
-    }
+  BitVector B; // B[i] = 1 if a character begins at i, and B[n] marks the end
+  for (size_t i = 0; i <= n; ++i){
     if (first ||
 	(i != text.size() && (text[i] & 0xC0) == 0x80)){
+      B.push_back(first);
       cur <<= 8;
       cur += text[i];
       first = false;
       continue;
     }
-    B[i/8] |= (1U << (i%8));
+    B.push_back(true);
     const uint32_t id = getiID(cur, true);
     T.push_back(id);
     
@@ -104,76 +291,52 @@ int SuffixArray::buildUTF8(){
     cur = text[i];
   }
 
+  vector<pair<uint64_t, uint32_t> > sorted(iterm2id.size());
+  for (uint32_t i = 0; i < sorted.size(); ++i){
+    sorted[i] = make_pair(iterm2id.getTerm(i), i);
+  }
+  sort(sorted.begin(), sorted.end());
+
   vector<uint32_t> mapping(iterm2id.size());
-  uint32_t alpha = 0;
-  for (map<uint64_t, uint32_t>::const_iterator it = iterm2id.begin(); it != iterm2id.end(); ++it){
-    mapping[it->second] = alpha++;
+  for (uint32_t alpha = 0; alpha < sorted.size(); ++alpha){
+    mapping[sorted[alpha].second] = alpha;
   }
+  sorted.clear();
 
   int alphaSize = static_cast<int>(iterm2id.size());
   iterm2id.clear();
-  id2iterm.clear();
 
   for (size_t i = 0; i < T.size(); ++i){
     T[i] = mapping[T[i]];
   }
   mapping.clear();
 
-  SA.resize(T.size()+1);
-  if (saisxx(T.begin(), SA.begin(), (int)T.size(), alphaSize) != 0){
+  SA.resize(T.size());
+  uint32_t* sa = SA.writable();
+  if (threadN > 1){
+    if (parallelSuffixSort(&T[0], sa, T.size(), alphaSize, threadN) == -1){
+      what_ << "cannot create threads";
+      return -1;
+    }
+  } else if (saisxx(T.begin(), sa, (int)T.size(), alphaSize) != 0){
     what_ << "saisxx error";
     return -1;
   }
 
-  vector<uint32_t> Btable(B.size() / 4);
-  uint32_t sum = 0;
-  for (size_t i = 0; i < B.size(); ++i){
-    if (i % 4 == 0){
-      Btable[i/4] = sum;
-    }
-    sum += _popcount_table[B[i]];
-  }
-  Btable.push_back(sum); // gurad
-
-  for (size_t i = 0; i < SA.size(); ++i){
-    SA[i] = select(SA[i], B, Btable); ///< Convert Position into Original Position
+  // Convert Position into Original Position
+  B.build();
+  SelectTask task(sa, SA.size(), B, max(threadN, 1));
+  if (runParallel(task, max(threadN, 1)) == -1){
+    what_ << "cannot create threads";
+    return -1;
   }
 
 
   return 0;
 }
 
-/// Return select(B, i), the position of (i+1)-th one in B
-uint32_t SuffixArray::select(const uint32_t i_, const vector<uint8_t>& B, const vector<uint32_t>& Btable) const{
-  uint32_t i = i_ + 1;
-  vector<uint32_t>::const_iterator it = lower_bound(Btable.begin(), Btable.end(), i);
-
-  it--;
-  uint32_t remain = i - *it;
-  uint32_t blockPos = (it - Btable.begin()) * 4;
-  uint32_t pos      = blockPos * 8;
-
-  for (uint32_t i = blockPos; ; i++){
-    uint32_t val =  _popcount_table[B[i]];
-    if (val < remain){
-      remain -= val;
-      pos += 8;
-      continue;
-    }
-    for (uint32_t j = 0;; ++j){
-      if ((B[i] >> j) & 1U){
-	remain--;
-	if (remain == 0) break;
-      }
-      pos++;
-    }
-    break;
-  }
-  return pos;
-}
-
 /// Return -1 if text[ind...] < query, or return 1 otherwise
-int SuffixArray::compare(const uint32_t ind, const vector<uint8_t>& query, uint32_t& match) const{
+int SuffixArray::compare(const uint64_t ind, const vector<uint8_t>& query, uint32_t& match) const{
   while (match < query.size() && match + ind < text.size()){
     if (text[ind+match] != query[match]){
       return (int)text[ind+match] - query[match];
@@ -188,13 +351,18 @@ int SuffixArray::compare(const uint32_t ind, const vector<uint8_t>& query, uint3
 }
 
 void SuffixArray::bsearch(const vector<uint8_t>& query, 
-			  uint32_t& beg, uint32_t& half, uint32_t& size, 
+			  uint64_t& beg, uint64_t& half, uint64_t& size, 
 			  uint32_t& match, uint32_t& lmatch, uint32_t& rmatch, 
-			  const int state){
+			  const int state, QueryProfile* prof){
+  uint64_t probes   = 0;
+  uint64_t compared = 0;
   half = size/2;
   for (; size > 0; size = half, half /= 2){
     match = min(lmatch, rmatch);
-    int r = compare(SA[beg + half], query, match);
+    const uint32_t match0 = match;
+    int r = compare(getSA(beg + half), query, match);
+    probes++;
+    compared += match - match0 + 1;
     if (r < 0 || (r == 0 && state==2)){
       beg += half + 1;
       half -= (1 - (size & 1));
@@ -206,19 +374,31 @@ void SuffixArray::bsearch(const vector<uint8_t>& query,
       break; 
     }
   }
+  if (prof){
+    prof->addCount(QueryProfile::SA_PROBES, probes);
+    prof->addCount(QueryProfile::BYTES_COMPARED, compared);
+  }
 }
 
-void SuffixArray::search(const vector<uint8_t>& query, vector<SeResult>& res){
-  res.clear();
-
+/// SA[lbeg...rbeg) are suffixes beginning with the query
+void SuffixArray::findRows(const vector<uint8_t>& query, uint64_t& lbeg, uint64_t& rbeg, 
+			   QueryProfile* prof){
+  lbeg = rbeg = 0;
   // Binary Search of the SA position containing a query as a prefix
-  uint32_t beg    = 0;
-  uint32_t size   = static_cast<uint32_t>(SA.size());
-  uint32_t half   = size/2;
+  uint64_t beg    = 0;
+  uint64_t size   = SA.size() + SA64.size();
+  if (!buckets.empty() && query.size() > 0){
+    // Suffixes beginning with the first bucketLen bytes (or all bytes of a shorter query)
+    const size_t len = min(query.size(), static_cast<size_t>(bucketLen));
+    const uint32_t c = getBucket(&query[0], len);
+    beg  = buckets[c];
+    size = buckets[c + (1U << (8 * (bucketLen - len)))] - beg;
+  }
+  uint64_t half   = size/2;
   uint32_t match  = 0;
   uint32_t lmatch = 0;
   uint32_t rmatch = 0;
-  bsearch(query, beg, half, size, match, lmatch, rmatch, 0);
+  bsearch(query, beg, half, size, match, lmatch, rmatch, 0, prof);
 
   //cerr << beg << endl
   //<< half << endl
@@ -226,35 +406,93 @@ void SuffixArray::search(const vector<uint8_t>& query, vector<SeResult>& res){
   //   << match << endl
   //   << lmatch << endl
   //   << rmatch << endl << endl;
-  
+
   if (size == 0) return; // No matching found
 
   // Lower Bound
-  uint32_t lbeg    = beg;
-  uint32_t lsize   = half;
-  uint32_t lhalf   = half / 2;
+  lbeg             = beg;
+  uint64_t lsize   = half;
+  uint64_t lhalf   = half / 2;
   uint32_t llmatch = lmatch;
   uint32_t lrmatch = match;
   uint32_t lmatch2 = 0;
-  bsearch(query, lbeg, lhalf, lsize, lmatch2, llmatch, lrmatch, 1);
+  bsearch(query, lbeg, lhalf, lsize, lmatch2, llmatch, lrmatch, 1, prof);
 
   // Upper Bound
-  uint32_t rbeg    = beg + half + 1;
-  uint32_t rsize   = size - half - 1;
-  uint32_t rhalf   = rsize / 2;
+  rbeg             = beg + half + 1;
+  uint64_t rsize   = size - half - 1;
+  uint64_t rhalf   = rsize / 2;
   uint32_t rlmatch = match;
   uint32_t rrmatch = rmatch;
   uint32_t rmatch2 = 0;
-  bsearch(query, rbeg, rhalf, rsize, rmatch2, rlmatch, rrmatch, 2);
+  bsearch(query, rbeg, rhalf, rsize, rmatch2, rlmatch, rrmatch, 2, prof);
+}
+
+void SuffixArray::search(const vector<uint8_t>& query, ResultSet& res, QueryProfile* prof){
+  res.clear();
+  vector<uint64_t> poses;
+  {
+    ProfileTimer timer(prof, QueryProfile::FETCH);
+    uint64_t lbeg = 0;
+    uint64_t rbeg = 0;
+    findRows(query, lbeg, rbeg, prof);
+
+    // SA[lbeg...rbeg) are matching positions;  
+    for (uint64_t i = lbeg; i < rbeg; ++i){
+      poses.push_back(getSA(i));
+    }
 
-  // SA[lbeg...rbeg) are matching positions;  
-  vector<uint32_t> poses;
-  for (uint32_t i = lbeg; i < rbeg; ++i){
-    poses.push_back(SA[i]);
+    sort(poses.begin(), poses.end());
   }
+  decodeDoc(poses, res, prof);
+}
 
-  sort(poses.begin(), poses.end());
-  decodeDoc(poses, res);
+void SuffixArray::listDocs(const vector<uint8_t>& query, vector<uint32_t>& docIDs, 
+			   vector<uint32_t>* counts, QueryProfile* prof){
+  if (docRowOffsets.empty()){
+    Minise::listDocs(query, docIDs, counts, prof);
+    return;
+  }
+  uint64_t beg = 0;
+  uint64_t end = 0;
+  {
+    ProfileTimer timer(prof, QueryProfile::FETCH);
+    findRows(query, beg, end, prof);
+  }
+  if (beg == end) return;
+
+  ProfileTimer timer(prof, QueryProfile::DECODE_DOC);
+  // The minimum row of prevRows in a range [l, r) within [beg, end) is the first row 
+  // of its document in [beg, end) if it is at most beg, and otherwise
+  // all documents in [l, r) have appeared before l.
+  const size_t first = docIDs.size();
+  vector<pair<uint64_t, uint64_t> > ranges(1, make_pair(beg, end));
+  while (!ranges.empty()){
+    const uint64_t l = ranges.back().first;
+    const uint64_t r = ranges.back().second;
+    ranges.pop_back();
+    if (r - l <= SCANROWS){
+      // Scanning a short range costs less than finding its minimums one by one
+      for (uint64_t i = l; i < r; ++i){
+	if (prevRows[i] <= beg) docIDs.push_back(getDocID(SA[i]));
+      }
+      continue;
+    }
+    const size_t i = prevRows.argmin(l, r);
+    if (prevRows[i] > beg) continue;
+    docIDs.push_back(getDocID(SA[i]));
+    if (l < i) ranges.push_back(make_pair(l, i));
+    if (i + 1 < r) ranges.push_back(make_pair(i + 1, r));
+  }
+  sort(docIDs.begin() + first, docIDs.end());
+  if (counts == NULL) return;
+
+  for (size_t i = first; i < docIDs.size(); ++i){
+    const uint32_t* rows = docRows.begin() + docRowOffsets[docIDs[i]];
+    const uint32_t* rowsEnd = docRows.begin() + docRowOffsets[docIDs[i] + 1];
+    counts->push_back(static_cast<uint32_t>(lower_bound(rows, rowsEnd, end) - 
+					    lower_bound(rows, rowsEnd, beg)));
+  }
 }
 
 int SuffixArray::save(const char* fileName){
@@ -273,19 +511,27 @@ int SuffixArray::save(const char* fileName){
   if (write(docOffsets, "docOffsets", ofs) == -1) return -1;
   if (write(titles, "titles", ofs) == -1) return -1;
   if (write(SA, "SA", ofs) == -1) return -1;
+  if (write(SA64, "SA64", ofs) == -1) return -1;
+  if (write(bucketLen, "bucketLen", ofs) == -1) return -1;
+  if (write(buckets, "buckets", ofs) == -1) return -1;
+  if (write(docRows, "docRows", ofs) == -1) return -1;
+  if (write(docRowOffsets, "docRowOffsets", ofs) == -1) return -1;
+  if (prevRows.save(ofs) == -1){
+    what_ << "write error: prevRows";
+    return -1;
+  }
 
   return 0;
 }
 
 int SuffixArray::load(const char* fileName){
-  ifstream ifs(fileName);
-  if (!ifs){
+  if (indexFile.open(fileName) == -1){
     what_ << "cannot open " << fileName;
     return -1;
   }
 
   int indexType = -1;
-  if (read(indexType, "indexType", ifs) == -1) return -1;
+  if (read(indexType, "indexType", indexFile) == -1) return -1;
   if (indexType == SUFFIXARRAY_UTF8){
     useUTF8 = true; 
   } else if (indexType == SUFFIXARRAY){
@@ -294,10 +540,20 @@ int SuffixArray::load(const char* fileName){
     what_ << "indexType is not SUFFIX ARRAY, SUFFIX ARRAY UTF8";
     return -1;
   }
-  if (read(text, "text", ifs) == -1) return -1;
-  if (read(docOffsets, "docOffsets", ifs) == -1) return -1;
-  if (read(titles, "titles", ifs) == -1) return -1;
-  if (read(SA, "SA", ifs) == -1) return -1;
+  if (read(text, "text", indexFile) == -1) return -1;
+  if (read(docOffsets, "docOffsets", indexFile) == -1) return -1;
+  if (read(titles, "titles", indexFile) == -1) return -1;
+  if (read(SA, "SA", indexFile) == -1) return -1;
+  if (read(SA64, "SA64", indexFile) == -1) return -1;
+  if (read(bucketLen, "bucketLen", indexFile) == -1) return -1;
+  if (read(buckets, "buckets", indexFile) == -1) return -1;
+  if (read(docRows, "docRows", indexFile) == -1) return -1;
+  if (read(docRowOffsets, "docRowOffsets", indexFile) == -1) return -1;
+  if (prevRows.load(indexFile) == -1){
+    what_ << "read error: prevRows";
+    return -1;
+  }
+  useDocList = !docRowOffsets.empty();
 	 
   docN = static_cast<uint32_t>(docOffsets.size())-1;
 
@@ -316,6 +572,11 @@ string SuffixArray::getIndexName() const{
 size_t SuffixArray::getIndexSize() const {
   size_t ret = Minise::getIndexSize(); // Calculate Basic Class Size()
   ret += SA.size() * sizeof(uint32_t);
+  ret += SA64.size() * sizeof(uint64_t);
+  ret += buckets.size() * sizeof(uint64_t);
+  ret += prevRows.getSize();
+  ret += docRows.size() * sizeof(uint32_t);
+  ret += docRowOffsets.size() * sizeof(uint32_t);
   return ret;
 }
   
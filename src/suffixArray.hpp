@@ -28,6 +28,7 @@
 #define SUFFIX_ARRAY_HPP__
 
 #include "miniseBase.hpp"
+#include "rangeMin.hpp"
 
 namespace SE{
 
@@ -35,6 +36,9 @@ namespace SE{
  * Suffix Array index
  */
 class SuffixArray : public Minise {
+  enum {
+    SCANROWS = 256 ///< Rows scanned at once to list documents
+  };
 public:
   SuffixArray(); ///< Constructor
   ~SuffixArray(); ///< Destructor
@@ -45,22 +49,88 @@ public:
 
   void setUTF8();
 
+  /**
+   * Build a table of SA ranges for the first len bytes of suffixes,
+   * so that binary search starts in the range of a query.
+   * The table has 256^len entries.
+   * @param len The number of bytes (0-3, 0 for no table)
+   */
+  void setBucketLength(const uint32_t len);
+
+  /**
+   * Build a document list so that listDocs() finds the documents of a term
+   * without visiting all its positions (Muthukrishnan's document listing).
+   * It takes three 32-bit words for each position of the text under 4 GB.
+   */
+  void setDocList();
+
+  /**
+   * Build SA by several threads instead of saisxx (not saved)
+   * @param threadN The number of threads
+   */
+  void setThreadN(const int threadN);
+
+  /**
+   * Build SA out of core for a corpus larger than memory (not for UTF-8).
+   * Documents are spooled to tmpPrefix.text instead of memory, and suffixes are sorted
+   * in memLimit bytes into tmpPrefix.sa by externalSuffixSort.
+   * Both files are mapped until the index is destroyed, and then removed.
+   * @param tmpPrefix The prefix of temporary files
+   * @param memLimit Bytes of memory to sort suffixes
+   * @return Return 0 if it succeded or -1 if failed to create the spool file
+   */
+  int setExternal(const std::string& tmpPrefix, const size_t memLimit);
+
+  void addDoc(const char* title, const std::vector<uint8_t>& content); ///< Spool the document out of core
+  int addFiles(const std::vector<std::string>& fileNames, const int threadN); ///< Read files one by one out of core
+
   std::string getIndexName() const;
   size_t getIndexSize() const;
 
 private:
-  void search(const std::vector<uint8_t>& query, std::vector<SeResult>& ret);
-  int compare(const uint32_t ind, const std::vector<uint8_t>& query, uint32_t& offset) const;
+  void search(const std::vector<uint8_t>& query, ResultSet& ret, QueryProfile* prof);
+  void listDocs(const std::vector<uint8_t>& query, std::vector<uint32_t>& docIDs, 
+		std::vector<uint32_t>* counts, QueryProfile* prof);
+  void findRows(const std::vector<uint8_t>& query, uint64_t& lbeg, uint64_t& rbeg, QueryProfile* prof);
+  int compare(const uint64_t ind, const std::vector<uint8_t>& query, uint32_t& offset) const;
   void bsearch(const std::vector<uint8_t>& query, 
-	       uint32_t& beg, uint32_t& half, uint32_t& size, 
-	       uint32_t& match, uint32_t& lmatch, uint32_t& rmatch, const int state);
+	       uint64_t& beg, uint64_t& half, uint64_t& size, 
+	       uint32_t& match, uint32_t& lmatch, uint32_t& rmatch, const int state, 
+	       QueryProfile* prof);
 
   void addIndex(const std::vector<uint8_t>& content);
-  uint32_t select(const uint32_t i, const std::vector<uint8_t>& B, const std::vector<uint32_t>& Btable) const;
+  Minise* createPart() const;
   int buildUTF8();
+  int buildExternal();
+  void buildBuckets();
+  int buildDocList();
+  uint32_t getDocID(const uint64_t pos) const; ///< The document containing the position
+  uint32_t getBucket(const uint8_t* p, const size_t len) const;
+
+  uint64_t getSA(const uint64_t i) const {
+    return SA64.empty() ? SA[i] : SA64[i];
+  }
   
-  std::vector<uint32_t> SA; ///< Suffix Array
+  MappedVector<uint32_t> SA;   ///< Suffix Array
+  MappedVector<uint64_t> SA64; ///< Suffix Array of a text over 4 GB (SA is empty then)
+  MappedVector<uint64_t> buckets; ///< SA[buckets[c]...buckets[c+1]) begin with c (256^bucketLen+1)
+  uint32_t bucketLen; ///< The number of bytes for buckets
+
+  // Document list: the rows of a document in SA[beg...end) are listed by minimums of prevRows
+  RangeMin prevRows; ///< 1 + the previous row of the same document for each row (0 for the first row)
+  MappedVector<uint32_t> docRows;       ///< Rows of each document in increasing order
+  MappedVector<uint32_t> docRowOffsets; ///< Rows of docID are docRows[docRowOffsets[docID]...docRowOffsets[docID+1])
+  bool useDocList;
+
+  int threadN; ///< The number of threads to build SA
   bool useUTF8;
+
+  // Out of core build
+  std::string tmpPrefix; ///< The prefix of temporary files (empty in memory)
+  size_t memLimit;       ///< Bytes of memory to sort suffixes
+  std::ofstream spool;   ///< Documents added so far
+  MappedFile textFile;   ///< The spooled text
+  MappedFile saFile;     ///< SA sorted out of core
 };
 
 }
@@ -0,0 +1,638 @@
+/*
+ * suffixSorter.cpp
+ * Copyright (c) 2009 Daisuke Okanohara All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "parallel.hpp"
+#include "suffixSorter.hpp"
+#include "waveletMatrix.hpp"
+
+using namespace std;
+
+namespace SE{
+
+namespace {
+
+const size_t DEPTH = 64;          ///< Characters compared directly before prefix doubling
+const size_t MAXBUCKETS = 1 << 18; ///< Buckets are by as many first characters as fit in this
+
+typedef pair<uint32_t, uint32_t> Group; ///< SA[first...second) have the same rank
+
+inline int compareChars(const uint8_t* a, const uint8_t* b, const size_t len){
+  return memcmp(a, b, len);
+}
+
+inline int compareChars(const uint32_t* a, const uint32_t* b, const size_t len){
+  for (size_t i = 0; i < len; ++i){
+    if (a[i] != b[i]) return (a[i] < b[i]) ? -1 : 1;
+  }
+  return 0;
+}
+
+/// Order suffixes by characters in [from, DEPTH), where a shorter suffix precedes
+template <class T>
+struct DepthLess {
+  DepthLess(const T* text, const size_t n, const size_t from) : text(text), n(n), from(from) {}
+
+  bool operator()(const uint32_t a, const uint32_t b) const {
+    const size_t la = min(n - a, DEPTH);
+    const size_t lb = min(n - b, DEPTH);
+    const size_t len = min(la, lb);
+    if (len > from){
+      const int c = compareChars(text + a + from, text + b + from, len - from);
+      if (c != 0) return c < 0;
+    }
+    return la < lb;
+  }
+
+  const T* text;
+  const size_t n;
+  const size_t from;
+};
+
+/// Order suffixes by the ranks of suffixes h characters after, where the end is the smallest
+struct RankLess {
+  RankLess(const uint32_t* rank, const size_t n, const size_t h) : rank(rank), n(n), h(h) {}
+
+  uint32_t getKey(const uint32_t a) const {
+    return (a + h < n) ? rank[a + h] : 0;
+  }
+
+  bool operator()(const uint32_t a, const uint32_t b) const {
+    return getKey(a) < getKey(b);
+  }
+
+  const uint32_t* rank;
+  const size_t n;
+  const size_t h;
+};
+
+template <class T>
+class SuffixSorter : public ParallelTask {
+public:
+  SuffixSorter(const T* text, uint32_t* SA, const size_t n, const uint32_t alphaSize, const int threadN) :
+    text(text), SA(SA), n(n), alphaSize(alphaSize), threadN(max(threadN, 1)), phase(COUNT), h(0) {
+  }
+
+  int sort(){
+    if (n == 0) return 0;
+    if (pool.start(threadN - 1) == -1) return -1;
+
+    // Characters in the text are renumbered from 1, where 0 is the end of the text
+    codes.assign(alphaSize, 0);
+    for (size_t i = 0; i < n; ++i){
+      codes[text[i]] = 1;
+    }
+    base = 1;
+    for (size_t c = 0; c < alphaSize; ++c){
+      if (codes[c]) codes[c] = static_cast<uint32_t>(base++);
+    }
+    keyN = 1;
+    bucketN = base;
+    while (keyN < DEPTH && bucketN * base <= MAXBUCKETS){
+      bucketN *= base;
+      keyN++;
+    }
+    codeBits = 1;
+    while ((static_cast<size_t>(1) << codeBits) < base){
+      codeBits++;
+    }
+    packN = min(64 / codeBits, DEPTH - keyN);
+
+    rank.resize(n);
+    head.resize(n);
+    counts.assign(threadN, vector<uint32_t>(bucketN, 0));
+    runPhase(COUNT, threadN);
+
+    // Each chunk writes its suffixes of a bucket after those of former chunks
+    bucketBegins.resize(bucketN + 1);
+    uint32_t sum = 0;
+    for (size_t c = 0; c < bucketN; ++c){
+      bucketBegins[c] = sum;
+      for (int t = 0; t < threadN; ++t){
+	const uint32_t count = counts[t][c];
+	counts[t][c] = sum;
+	sum += count;
+      }
+    }
+    bucketBegins[bucketN] = sum;
+    runPhase(SCATTER, threadN);
+    counts.clear();
+
+    groups.clear();
+    for (size_t c = 0; c < bucketN; ++c){
+      if (bucketBegins[c+1] - bucketBegins[c] > 1){
+	groups.push_back(Group(bucketBegins[c], bucketBegins[c+1]));
+      }
+    }
+    bucketBegins.clear();
+
+    // The first round compares characters, and next rounds double the length of sorted prefixes.
+    for (h = 0; !groups.empty(); h = (h == 0) ? DEPTH : h * 2){
+      splitTasks();
+      runPhase(SORT, static_cast<int>(taskGroups.size()) - 1);
+      runPhase(RANK, static_cast<int>(taskGroups.size()) - 1);
+
+      groups.clear();
+      for (size_t t = 0; t < nextGroups.size(); ++t){
+	groups.insert(groups.end(), nextGroups[t].begin(), nextGroups[t].end());
+      }
+      nextGroups.clear();
+    }
+    return 0;
+  }
+
+  void run(const int taskID){
+    switch (phase){
+    case COUNT:
+      for (size_t i = getChunk(taskID); i < getChunk(taskID + 1); ++i){
+	counts[taskID][getKey(i)]++;
+      }
+      break;
+    case SCATTER:
+      for (size_t i = getChunk(taskID); i < getChunk(taskID + 1); ++i){
+	const size_t c = getKey(i);
+	SA[counts[taskID][c]++] = static_cast<uint32_t>(i);
+	rank[i] = bucketBegins[c] + 1;
+      }
+      break;
+    case SORT:
+      for (size_t g = taskGroups[taskID]; g < taskGroups[taskID + 1]; ++g){
+	if (h == 0){
+	  sortByChars(groups[g]);
+	} else {
+	  sortGroup(groups[g], RankLess(&rank[0], n, h));
+	}
+      }
+      break;
+    case RANK:
+      for (size_t g = taskGroups[taskID]; g < taskGroups[taskID + 1]; ++g){
+	setRanks(groups[g], nextGroups[taskID]);
+      }
+      break;
+    }
+  }
+
+private:
+  enum Phase {
+    COUNT,   ///< Count bucket sizes of each chunk of the text
+    SCATTER, ///< Put suffixes into buckets
+    SORT,    ///< Sort each group and mark heads of new groups
+    RANK     ///< Rank suffixes by new groups (after all SORT tasks read old ranks)
+  };
+
+  void runPhase(const Phase p, const int taskN){
+    phase = p;
+    pool.run(*this, taskN);
+  }
+
+  size_t getChunk(const int taskID) const {
+    return n * taskID / threadN;
+  }
+
+  size_t getKey(const size_t i) const {
+    size_t key = 0;
+    for (size_t j = i; j < i + keyN; ++j){
+      key = key * base + ((j < n) ? codes[text[j]] : 0);
+    }
+    return key;
+  }
+
+  /// Divide groups into tasks of almost the same number of suffixes
+  void splitTasks(){
+    size_t total = 0;
+    for (size_t g = 0; g < groups.size(); ++g){
+      total += groups[g].second - groups[g].first;
+    }
+    const size_t taskN = min(groups.size(), static_cast<size_t>(threadN) * 8);
+    taskGroups.clear();
+    taskGroups.push_back(0);
+    size_t acc = 0;
+    for (size_t g = 0; g < groups.size(); ++g){
+      acc += groups[g].second - groups[g].first;
+      if (acc * taskN >= total * taskGroups.size()){
+	taskGroups.push_back(g + 1);
+      }
+    }
+    if (taskGroups.back() != groups.size()){
+      taskGroups.push_back(groups.size());
+    }
+    nextGroups.assign(taskGroups.size() - 1, vector<Group>());
+  }
+
+  /// Codes of packN characters after the bucket
+  uint64_t getPacked(const size_t i) const {
+    uint64_t packed = 0;
+    for (size_t j = i + keyN; j < i + keyN + packN; ++j){
+      packed = (packed << codeBits) + ((j < n) ? codes[text[j]] : 0);
+    }
+    return packed;
+  }
+
+  /// Sort a bucket by characters, where packed codes are compared first to avoid random access to the text
+  void sortByChars(const Group& g){
+    vector<pair<uint64_t, uint32_t> > packed(g.second - g.first);
+    for (size_t k = 0; k < packed.size(); ++k){
+      packed[k] = make_pair(getPacked(SA[g.first + k]), SA[g.first + k]);
+    }
+    std::sort(packed.begin(), packed.end());
+    for (size_t k = 0; k < packed.size(); ++k){
+      SA[g.first + k] = packed[k].second;
+    }
+
+    const DepthLess<T> less(text, n, keyN + packN);
+    for (size_t k = 0; k < packed.size(); ){
+      size_t e = k + 1;
+      while (e < packed.size() && packed[e].first == packed[k].first) ++e;
+      sortGroup(Group(static_cast<uint32_t>(g.first + k), static_cast<uint32_t>(g.first + e)), less);
+      k = e;
+    }
+  }
+
+  template <class Less>
+  void sortGroup(const Group& g, const Less& less){
+    std::sort(SA + g.first, SA + g.second, less);
+    head[g.first] = 1;
+    for (size_t k = g.first + 1; k < g.second; ++k){
+      head[k] = less(SA[k-1], SA[k]) ? 1 : 0;
+    }
+  }
+
+  void setRanks(const Group& g, vector<Group>& next){
+    for (size_t k = g.first; k < g.second; ){
+      size_t e = k + 1;
+      while (e < g.second && !head[e]) ++e;
+      for (size_t j = k; j < e; ++j){
+	rank[SA[j]] = static_cast<uint32_t>(k + 1);
+      }
+      if (e - k > 1){
+	next.push_back(Group(static_cast<uint32_t>(k), static_cast<uint32_t>(e)));
+      }
+      k = e;
+    }
+  }
+
+  const T* text;
+  uint32_t* SA;
+  const size_t n;
+  const size_t alphaSize;
+  const int threadN;
+  vector<uint32_t> codes; ///< Codes of characters for buckets
+  size_t base;     ///< The number of codes
+  size_t keyN;     ///< The number of characters for buckets
+  size_t bucketN;  ///< The number of buckets
+  size_t codeBits; ///< The number of bits of a code
+  size_t packN;    ///< The number of characters packed into 64 bits
+
+  ThreadPool pool;
+  Phase phase;
+  size_t h;        ///< Ranks are of the first h characters, and the first round (h = 0) compares characters
+
+  vector<uint32_t> rank; ///< One plus the first position of the group of each suffix
+  vector<uint8_t>  head; ///< head[k] = 1 if a new group begins at SA[k] after sorting
+  vector<vector<uint32_t> > counts; ///< Bucket sizes of each chunk, then the next position to write
+  vector<uint32_t> bucketBegins;
+  vector<Group>    groups;     ///< Groups to be sorted in this round
+  vector<size_t>   taskGroups; ///< Groups of the task t are [taskGroups[t], taskGroups[t+1])
+  vector<vector<Group> > nextGroups; ///< Groups to be sorted in the next round by each task
+};
+
+}
+
+namespace {
+
+/// Bytes of memory used for each suffix of a block (text, flags, SA and the sorter, or SA, BWT and gaps)
+const uint64_t BYTES_PER_SUFFIX = 14;
+
+/// Blocks are sorted as uint32_t strings with a terminal character
+const uint64_t MAX_BLOCK_LEN = 0x7FFFFFFFULL;
+
+const size_t IO_BUF_SIZE = 0x10000;
+
+/// Read values of a file by blocks
+template <class T>
+class FileReader {
+public:
+  FileReader() : fp(NULL), buf(IO_BUF_SIZE), cur(0), size(0) {}
+  ~FileReader(){
+    if (fp != NULL) fclose(fp);
+  }
+
+  int open(const string& fileName){
+    fp = fopen(fileName.c_str(), "rb");
+    return (fp == NULL) ? -1 : 0;
+  }
+
+  bool next(T& v){
+    if (cur == size){
+      size = fread(&buf[0], sizeof(buf[0]), buf.size(), fp);
+      cur  = 0;
+      if (size == 0) return false;
+    }
+    v = buf[cur++];
+    return true;
+  }
+
+private:
+  FileReader(const FileReader&);
+  FileReader& operator=(const FileReader&);
+
+  FILE* fp;
+  vector<T> buf;
+  size_t cur;
+  size_t size;
+};
+
+/// Write values to a file by blocks
+template <class T>
+class FileWriter {
+public:
+  FileWriter() : fp(NULL), failed(false) {
+    buf.reserve(IO_BUF_SIZE);
+  }
+  ~FileWriter(){
+    close();
+  }
+
+  int open(const string& fileName){
+    fp = fopen(fileName.c_str(), "wb");
+    return (fp == NULL) ? -1 : 0;
+  }
+
+  void put(const T v){
+    buf.push_back(v);
+    if (buf.size() == IO_BUF_SIZE) flush();
+  }
+
+  int close(){
+    if (fp != NULL){
+      flush();
+      if (fclose(fp) != 0) failed = true;
+      fp = NULL;
+    }
+    return failed ? -1 : 0;
+  }
+
+private:
+  FileWriter(const FileWriter&);
+  FileWriter& operator=(const FileWriter&);
+
+  void flush(){
+    if (!buf.empty() && fwrite(&buf[0], sizeof(buf[0]), buf.size(), fp) != buf.size()) failed = true;
+    buf.clear();
+  }
+
+  FILE* fp;
+  vector<T> buf;
+  bool failed;
+};
+
+string getTmpName(const char* tmpPrefix, const char* kind, const size_t id){
+  ostringstream os;
+  os << tmpPrefix << "." << kind << id;
+  return os.str();
+}
+
+/**
+ * gt[j-b] = 1 iff T[j...] > T[e...] for j in [b, e), and gt[e-b] = 0.
+ * Each position is matched with T[e...] by the Z algorithm, so the text
+ * is scanned in linear time however long the common prefixes are.
+ */
+void compareWithTail(const uint8_t* T, const uint64_t n, const uint64_t b, const uint64_t e,
+		     vector<uint8_t>& gt){
+  const uint64_t m = e - b;
+  const uint64_t p = n - e;
+  gt.assign(m + 1, 0);
+  if (p == 0){
+    fill(gt.begin(), gt.begin() + m, 1);
+    return;
+  }
+
+  // Z[k] = lcp(P[k...], P) for P = T[e...n)
+  const uint8_t* P = T + e;
+  vector<uint64_t> Z(min(m, p));
+  Z[0] = p;
+  uint64_t l = 0;
+  uint64_t r = 0;
+  for (uint64_t k = 1; k < Z.size(); ++k){
+    uint64_t z = (k < r) ? min(Z[k - l], r - k) : 0;
+    if (k + z >= r){
+      while (k + z < p && P[z] == P[k + z]) ++z;
+      l = k;
+      r = k + z;
+    }
+    Z[k] = z;
+  }
+
+  // T[l...r) = P[0...r-l)
+  l = r = b;
+  for (uint64_t j = b; j < e; ++j){
+    uint64_t z = (j < r) ? min(Z[j - l], r - j) : 0;
+    if (j + z >= r){
+      while (j + z < n && z < p && T[j + z] == P[z]) ++z;
+      l = j;
+      r = j + z;
+    }
+    // T[j...] is longer than P
+    gt[j - b] = (z == p) || (j + z < n && T[j + z] > P[z]);
+  }
+}
+
+/**
+ * Sort suffixes beginning in [b, e) by the prefix doubling sorter.
+ * X[k] = 2 T[b+k] + gt[k+1] and a terminal X[m] larger than others
+ * break ties at e as the suffixes after e do.
+ */
+int sortBlock(const uint8_t* T, const uint64_t b, const uint64_t e,
+	      const vector<uint8_t>& gt, vector<uint32_t>& SA){
+  const size_t m = e - b;
+  vector<uint32_t> X(m + 1);
+  for (size_t k = 0; k < m; ++k){
+    X[k] = 2 * T[b + k] + gt[k + 1];
+  }
+  X[m] = 0x200;
+  SA.resize(m + 1);
+  if (parallelSuffixSort(&X[0], &SA[0], m + 1, 0x201, 1) == -1) return -1;
+  SA.pop_back(); // the terminal alone
+  return 0;
+}
+
+/**
+ * Count gap[i], the number of suffixes of [e, n) between the (i-1)-th and i-th suffixes of the block.
+ * The rank of T[s...] among the block follows from that of T[s+1...] by the BWT of the block,
+ * and tailGt (T[s...] > T[e...] for s = n-1, ..., e) tells where T[e-1...] is.
+ * nextGt is written for the next block (T[s...] > T[b...] for s = n-1, ..., e).
+ */
+int countGaps(const uint8_t* T, const uint64_t n, const uint64_t b, const uint64_t e,
+	      const vector<uint32_t>& SA, const uint64_t rankB,
+	      const string& tailGt, FileWriter<uint8_t>* nextGt, vector<uint64_t>& gap){
+  const size_t m = e - b;
+  vector<uint64_t> C(0x101);
+  vector<uint8_t> bwt(m);
+  for (size_t i = 0; i < m; ++i){
+    C[T[b + i] + 1]++;
+    bwt[i] = (SA[i] > 0) ? T[b + SA[i] - 1] : 0;
+  }
+  for (size_t c = 1; c <= 0x100; ++c){
+    C[c] += C[c-1];
+  }
+  WaveletMatrix wm;
+  wm.build(bwt);
+  vector<uint8_t>().swap(bwt);
+
+  FileReader<uint8_t> gtReader;
+  if (gtReader.open(tailGt) == -1) return -1;
+
+  gap.assign(m + 1, 0);
+  const uint8_t last = T[e - 1];
+  uint64_t rank = 0;  // of the empty suffix
+  uint8_t gt = 0;     // T[s+1...] > T[e...]
+  for (uint64_t s = n; s-- > e; ){
+    const uint8_t c = T[s];
+    const uint64_t prev = rank;
+    rank = C[c] + wm.rank(c, prev);
+    if (c == 0 && rankB < prev) --rank;  // T[b-1] is not in the block
+    if (c == last && gt) ++rank;         // T[e-1...] < T[s...]
+    gap[rank]++;
+    if (nextGt != NULL) nextGt->put(rank > rankB);
+    if (!gtReader.next(gt)) return -1;
+  }
+  return 0;
+}
+
+/// Write suffixes of the block interleaved with those of the tail by gap
+template <class Pos>
+int mergeBlock(const uint64_t b, const vector<uint32_t>& SA, const vector<uint64_t>& gap,
+	       const string& tailFile, const string& outFile){
+  FileReader<uint64_t> tail;
+  FileWriter<Pos> out;
+  if (!tailFile.empty() && tail.open(tailFile) == -1) return -1;
+  if (out.open(outFile) == -1) return -1;
+  for (size_t i = 0; i < gap.size(); ++i){
+    for (uint64_t g = 0; g < gap[i]; ++g){
+      uint64_t pos = 0;
+      if (!tail.next(pos)) return -1;
+      out.put(static_cast<Pos>(pos));
+    }
+    if (i < SA.size()){
+      out.put(static_cast<Pos>(b + SA[i]));
+    }
+  }
+  return out.close();
+}
+
+/**
+ * Add suffixes beginning in [b, e) to the SA of [e, n) saved in tailSA.
+ * The result is saved as uint64_t to nextSA, or as Pos to saFile if b = 0.
+ */
+template <class Pos>
+int addBlock(const uint8_t* T, const uint64_t n, const uint64_t b, const uint64_t e,
+	     const string& tailSA, const string& tailGt,
+	     const string& nextSA, const string& nextGt, const char* saFile){
+  vector<uint8_t> gt;
+  compareWithTail(T, n, b, e, gt);
+  vector<uint32_t> SA;
+  if (sortBlock(T, b, e, gt, SA) == -1) return -1;
+
+  const size_t m = e - b;
+  uint64_t rankB = 0;
+  for (size_t i = 0; i < m; ++i){
+    if (SA[i] == 0) rankB = i;
+  }
+
+  FileWriter<uint8_t> gtWriter;
+  if (b > 0 && gtWriter.open(nextGt) == -1) return -1;
+  vector<uint64_t> gap(m + 1, 0);
+  if (e < n && countGaps(T, n, b, e, SA, rankB, tailGt, (b > 0) ? &gtWriter : NULL, gap) == -1) return -1;
+  if (b > 0){
+    // T[j...] > T[b...] for j = e-1, ..., b follow those of the tail
+    for (size_t i = 0; i < m; ++i){
+      gt[SA[i]] = (i > rankB);
+    }
+    for (size_t j = m; j-- > 0; ){
+      gtWriter.put(gt[j]);
+    }
+    if (gtWriter.close() == -1) return -1;
+  }
+  vector<uint8_t>().swap(gt);
+
+  if (b > 0){
+    return mergeBlock<uint64_t>(b, SA, gap, (e < n) ? tailSA : string(), nextSA);
+  } else {
+    return mergeBlock<Pos>(b, SA, gap, (e < n) ? tailSA : string(), saFile);
+  }
+}
+
+}
+
+int externalSuffixSort(const uint8_t* T, const uint64_t n, const char* saFile, 
+		       const char* tmpPrefix, const size_t memLimit){
+  const uint64_t blockLen = max(min(static_cast<uint64_t>(memLimit) / BYTES_PER_SUFFIX, MAX_BLOCK_LEN),
+				static_cast<uint64_t>(1));
+  if (n == 0){
+    FileWriter<uint32_t> out;
+    if (out.open(saFile) == -1) return -1;
+    return out.close();
+  }
+
+  // Blocks are added from the end, and the SA of the tail and its flags alternate between two files
+  int ret = 0;
+  size_t cur = 0;
+  for (uint64_t e = n; e > 0 && ret == 0; cur ^= 1){
+    const uint64_t b = e - min(e, blockLen);
+    const string tailSA = getTmpName(tmpPrefix, "sa", cur);
+    const string tailGt = getTmpName(tmpPrefix, "gt", cur);
+    const string nextSA = getTmpName(tmpPrefix, "sa", cur ^ 1);
+    const string nextGt = getTmpName(tmpPrefix, "gt", cur ^ 1);
+    if (n <= 0xFFFFFFFFULL){
+      ret = addBlock<uint32_t>(T, n, b, e, tailSA, tailGt, nextSA, nextGt, saFile);
+    } else {
+      ret = addBlock<uint64_t>(T, n, b, e, tailSA, tailGt, nextSA, nextGt, saFile);
+    }
+    e = b;
+  }
+  for (size_t id = 0; id < 2; ++id){
+    remove(getTmpName(tmpPrefix, "sa", id).c_str());
+    remove(getTmpName(tmpPrefix, "gt", id).c_str());
+  }
+  return ret;
+}
+
+int parallelSuffixSort(const uint8_t* T, uint32_t* SA, const size_t n, const int threadN){
+  SuffixSorter<uint8_t> sorter(T, SA, n, 0x100, threadN);
+  return sorter.sort();
+}
+
+int parallelSuffixSort(const uint32_t* T, uint32_t* SA, const size_t n, const uint32_t alphaSize, const int threadN){
+  SuffixSorter<uint32_t> sorter(T, SA, n, alphaSize, threadN);
+  return sorter.sort();
+}
+
+}
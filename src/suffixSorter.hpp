@@ -0,0 +1,75 @@
+/*
+ * suffixSorter.hpp
+ * Copyright (c) 2009 Daisuke Okanohara All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef SUFFIX_SORTER_HPP__
+#define SUFFIX_SORTER_HPP__
+
+#include <stdint.h>
+#include <cstddef>
+
+namespace SE{
+
+/**
+ * Build the suffix array of T[0...n) by threadN threads.
+ * Suffixes are bucketed by their first characters, and each bucket is
+ * sorted by a bounded string comparison followed by prefix doubling (Larsson-Sadakane)
+ * of still tied groups. Groups are independent, so they are sorted in parallel.
+ * The result is the same as saisxx, but it uses 5n bytes of working area in addition to SA.
+ * @param T The text
+ * @param SA The suffix array to be built (n entries)
+ * @param n The length of T
+ * @param threadN The number of threads
+ * @return Return 0 if it succeded or -1 if failed to create threads
+ */
+int parallelSuffixSort(const uint8_t* T, uint32_t* SA, const size_t n, const int threadN);
+
+/**
+ * Build the suffix array of T[0...n) where each character is in [0, alphaSize)
+ * @see parallelSuffixSort(const uint8_t*, uint32_t*, const size_t, const int)
+ */
+int parallelSuffixSort(const uint32_t* T, uint32_t* SA, const size_t n, const uint32_t alphaSize, const int threadN);
+
+/**
+ * Build the suffix array of T[0...n) out of core in bounded memory.
+ * T is split into blocks of memLimit/14 suffixes, which are added from the end.
+ * Each block is sorted by parallelSuffixSort after its suffixes are compared with the
+ * following tail by the Z algorithm, and merged into the SA of the tail by the ranks of
+ * tail suffixes among the block, computed with the BWT of the block. No common prefix is
+ * scanned twice, so repetitive texts take as long as others: O(n^2 / blockLen) in total.
+ * T is only read, so it may be a mapped file larger than memory.
+ * @param T The text
+ * @param n The length of T
+ * @param saFile A file to write SA, of uint32_t if n < 2^32 or uint64_t otherwise
+ * @param tmpPrefix The prefix of temporary files (removed after sorting)
+ * @param memLimit Bytes of memory to sort suffixes
+ * @return Return 0 if it succeded or -1 if failed to write files
+ */
+int externalSuffixSort(const uint8_t* T, const uint64_t n, const char* saFile, 
+		       const char* tmpPrefix, const size_t memLimit);
+
+}
+
+#endif // SUFFIX_SORTER_HPP__
@@ -0,0 +1,270 @@
+/*
+ * termDic.hpp
+ * Copyright (c) 2009 Daisuke Okanohara All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef TERM_DIC_HPP__
+#define TERM_DIC_HPP__
+
+#include <string>
+#include <vector>
+#include <cstring>
+#include <stdint.h>
+#include "mappedVector.hpp"
+
+namespace SE{
+
+class Minise;
+
+/**
+ * Terms as strings stored in one character array
+ */
+class StringKeys {
+public:
+  typedef std::string key_type;
+
+  StringKeys() {
+    offsets.push_back(0);
+  }
+
+  static uint32_t hash(const key_type& key){
+    uint64_t h = 14695981039346656037ULL; // FNV-1a
+    for (size_t i = 0; i < key.size(); ++i){
+      h ^= static_cast<uint8_t>(key[i]);
+      h *= 1099511628211ULL;
+    }
+    return static_cast<uint32_t>(h ^ (h >> 32));
+  }
+
+  uint32_t hashAt(const uint32_t id) const{
+    return hash(get(id));
+  }
+
+  bool equal(const uint32_t id, const key_type& key) const{
+    const uint32_t beg = offsets[id];
+    const uint32_t len = offsets[id+1] - beg;
+    return len == key.size() && memcmp(&chars[0] + beg, key.data(), len) == 0;
+  }
+
+  void add(const key_type& key){
+    chars.append(key.begin(), key.end());
+    offsets.push_back(static_cast<uint32_t>(chars.size()));
+  }
+
+  key_type get(const uint32_t id) const{
+    return key_type(chars.begin() + offsets[id], chars.begin() + offsets[id+1]);
+  }
+
+  size_t size() const{
+    return offsets.size() - 1;
+  }
+
+  size_t byteSize() const{
+    return chars.size() + offsets.size() * sizeof(uint32_t);
+  }
+
+private:
+  friend class Minise;
+  MappedVector<char> chars;       ///< Concatenated terms
+  MappedVector<uint32_t> offsets; ///< Beginning positions of terms in chars
+};
+
+/**
+ * Terms as 64-bit integers (UTF-8 characters and their pairs)
+ */
+class IntKeys {
+public:
+  typedef uint64_t key_type;
+
+  static uint32_t hash(const key_type key){
+    return static_cast<uint32_t>((key * 0x9E3779B97F4A7C15ULL) >> 32);
+  }
+
+  uint32_t hashAt(const uint32_t id) const{
+    return hash(keys[id]);
+  }
+
+  bool equal(const uint32_t id, const key_type key) const{
+    return keys[id] == key;
+  }
+
+  void add(const key_type key){
+    keys.push_back(key);
+  }
+
+  key_type get(const uint32_t id) const{
+    return keys[id];
+  }
+
+  size_t size() const{
+    return keys.size();
+  }
+
+  size_t byteSize() const{
+    return keys.size() * sizeof(uint64_t);
+  }
+
+private:
+  friend class Minise;
+  MappedVector<uint64_t> keys; ///< Terms in order of termIDs
+};
+
+/**
+ * Dictionary from terms to termIDs by open addressing with linear probing.
+ * TermIDs are assigned in order of registration.
+ * At index building, hash values of terms are kept to speed up probing
+ * and rehashing. freeze() drops them and leaves a compact table of termIDs
+ * which is saved with the index and used in place after loading.
+ */
+template<class Keys> class TermDic {
+public:
+  typedef typename Keys::key_type key_type;
+
+  enum {
+    EMPTY = 0xFFFFFFFF ///< An empty slot and an unknown term
+  };
+
+  TermDic() {
+    table.resize(16, EMPTY);
+  }
+
+  /**
+   * @param key A term
+   * @return TermID or EMPTY if the term is unknown
+   */
+  uint32_t find(const key_type& key) const{
+    const uint32_t h    = Keys::hash(key);
+    const size_t   mask = table.size() - 1;
+    const bool useHash  = (hashes.size() == keys.size());
+    for (size_t i = h & mask; ; i = (i + 1) & mask){
+      const uint32_t id = table[i];
+      if (id == EMPTY) return EMPTY;
+      if ((!useHash || hashes[id] == h) && keys.equal(id, key)){
+	return id;
+      }
+    }
+  }
+
+  /**
+   * Register a new term. The term should not be registered yet.
+   * @param key A term
+   * @return A new termID
+   */
+  uint32_t add(const key_type& key){
+    thaw();
+    if ((keys.size() + 1) * 2 > table.size()){
+      rehash(table.size() * 2);
+    }
+    const uint32_t id = static_cast<uint32_t>(keys.size());
+    const uint32_t h  = Keys::hash(key);
+    keys.add(key);
+    hashes.push_back(h);
+    insert(id, h);
+    return id;
+  }
+
+  /**
+   * @param id A termID
+   * @return The term of the id
+   */
+  key_type getTerm(const uint32_t id) const{
+    return keys.get(id);
+  }
+
+  /**
+   * @return The number of terms
+   */
+  size_t size() const{
+    return keys.size();
+  }
+
+  /**
+   * @return The number of bytes used by the dictionary
+   */
+  size_t byteSize() const{
+    return keys.byteSize() + table.size() * sizeof(uint32_t) + hashes.size() * sizeof(uint32_t);
+  }
+
+  /**
+   * Shrink the table to the smallest size and release building data.
+   */
+  void freeze(){
+    if (hashes.size() != keys.size()) return; // Already frozen
+    size_t capacity = 16;
+    while (keys.size() * 2 > capacity){
+      capacity *= 2;
+    }
+    rehash(capacity);
+    std::vector<uint32_t>().swap(hashes);
+  }
+
+  void clear(){
+    keys = Keys();
+    table.clear();
+    table.resize(16, EMPTY);
+    std::vector<uint32_t>().swap(hashes);
+  }
+
+private:
+  friend class Minise;
+
+  void thaw(){
+    if (hashes.size() != keys.size()){
+      hashes.resize(keys.size());
+      for (size_t i = 0; i < keys.size(); ++i){
+	hashes[i] = keys.hashAt(static_cast<uint32_t>(i));
+      }
+    }
+    if (table.isMapped()){
+      rehash(table.size()); // Make the table writable
+    }
+  }
+
+  void rehash(const size_t capacity){
+    table.clear();
+    table.resize(capacity, EMPTY);
+    const bool useHash = (hashes.size() == keys.size());
+    for (size_t i = 0; i < keys.size(); ++i){
+      const uint32_t id = static_cast<uint32_t>(i);
+      insert(id, useHash ? hashes[i] : keys.hashAt(id));
+    }
+  }
+
+  void insert(const uint32_t id, const uint32_t h){
+    const size_t mask = table.size() - 1;
+    size_t i = h & mask;
+    while (table[i] != EMPTY){
+      i = (i + 1) & mask;
+    }
+    table.writable()[i] = id;
+  }
+
+  Keys keys;                     ///< Terms in order of termIDs
+  MappedVector<uint32_t> table;  ///< Hash table of termIDs
+  std::vector<uint32_t> hashes;  ///< Hash values of terms (only at building)
+};
+
+}
+
+#endif // TERM_DIC_HPP__
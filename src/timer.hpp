@@ -6,7 +6,7 @@
 #include <stdio.h>
 
 namespace SE {  
-double gettimeofday_sec()
+inline double gettimeofday_sec()
 {
   struct timeval tv;
   gettimeofday(&tv, NULL);
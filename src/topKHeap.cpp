@@ -0,0 +1,70 @@
+/*
+ * topKHeap.cpp
+ * Copyright (c) 2009 Daisuke Okanohara All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <algorithm>
+#include "topKHeap.hpp"
+
+using namespace std;
+
+namespace SE{
+
+namespace {
+
+/// Higher score first, and smaller docID first for ties
+class CompByScore{
+public:
+  bool operator () (const pair<double, uint32_t>& p1, const pair<double, uint32_t>& p2) const{
+    if (p1.first != p2.first) return p1.first > p2.first;
+    return p1.second < p2.second;
+  }
+};
+
+}
+
+TopKHeap::TopKHeap(const size_t k) : k(k) {
+}
+
+bool TopKHeap::push(const double score, const uint32_t docID){
+  const pair<double, uint32_t> p(score, docID);
+  if (heap.size() < k){
+    heap.push_back(p);
+    push_heap(heap.begin(), heap.end(), CompByScore());
+    return true;
+  }
+  if (k == 0 || !CompByScore()(p, heap.front())) return false;
+  pop_heap(heap.begin(), heap.end(), CompByScore());
+  heap.back() = p;
+  push_heap(heap.begin(), heap.end(), CompByScore());
+  return true;
+}
+
+void TopKHeap::sorted(vector<pair<double, uint32_t> >& ret){
+  sort_heap(heap.begin(), heap.end(), CompByScore());
+  ret.swap(heap);
+  heap.clear();
+}
+
+}
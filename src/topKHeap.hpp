@@ -0,0 +1,82 @@
+/*
+ * topKHeap.hpp
+ * Copyright (c) 2009 Daisuke Okanohara All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef TOP_K_HEAP_HPP__
+#define TOP_K_HEAP_HPP__
+
+#include <vector>
+#include <cstddef>
+#include <stdint.h>
+
+namespace SE{
+
+/**
+ * Bounded heap which keeps the best k documents.
+ * A higher score is better, and a smaller docID is better for ties.
+ */
+class TopKHeap {
+public:
+  /**
+   * @param k The number of documents to be kept
+   */
+  TopKHeap(const size_t k);
+
+  /**
+   * Offer a document
+   * @return true if the document is kept
+   */
+  bool push(const double score, const uint32_t docID);
+
+  /**
+   * @return true if k documents are kept (never for k == 0, which keeps nothing)
+   */
+  bool full() const {
+    return k > 0 && heap.size() >= k;
+  }
+
+  /**
+   * A document can be kept only if its score is above this,
+   * when it follows all kept documents in docID order.
+   * @return The score of the k-th document (valid if full())
+   */
+  double threshold() const {
+    return heap.front().first;
+  }
+
+  /**
+   * Move kept documents to ret in descending order of scores
+   * @param ret Pairs of (score, docID)
+   */
+  void sorted(std::vector<std::pair<double, uint32_t> >& ret);
+
+private:
+  const size_t k;
+  std::vector<std::pair<double, uint32_t> > heap; ///< The top is the worst document
+};
+
+}
+
+#endif // TOP_K_HEAP_HPP__
@@ -31,64 +31,37 @@ using namespace std;
 
 namespace SE{
 
-VarByte::VarByte() {}
-VarByte::VarByte(const vector<uint32_t>& v) {
-  encode(v);
-}
-VarByte::~VarByte() {}
-
-void VarByte::encode(const vector<uint32_t>& v){
+void VarByte::encode(const vector<uint32_t>& v, vector<uint8_t>& out){
   uint32_t prev = 0;
   for (size_t i = 0; i < v.size(); ++i){
     uint32_t dif = v[i] - prev;
     while (dif >= 0x80){
-      B.push_back(dif & 0x7F);
+      out.push_back(dif & 0x7F);
       dif >>= 7;
     }
     prev = v[i] + 1;
-    B.push_back(dif + 0x80);
+    out.push_back(dif + 0x80);
   }
 }
 
-void VarByte::decode(vector<uint32_t>& v){
-  uint32_t output = 0;
+void VarByte::decode(const uint8_t* p, const size_t size, uint32_t* v, const size_t n){
   uint32_t prev = 0;
-  for (size_t i = 0; i < B.size(); ++i){
+  size_t i = 0;
+  for (size_t output = 0; output < n; ++output){
     uint32_t count = 0;
     uint32_t x = 0;
-    while (B[i] < 0x80){
-      x += (uint32_t)B[i] << (7*count);
+    while (p[i] < 0x80){
+      x += (uint32_t)p[i] << (7*count);
       ++i;
       ++count;
     }
-    x += (uint32_t)(B[i] - 0x80) << (7*count);
-    assert(output < v.size());
+    x += (uint32_t)(p[i] - 0x80) << (7*count);
+    ++i;
+    assert(i <= size);
     v[output] = x + prev;
     prev = v[output] + 1;
-    output++;
   }
 }
 
-size_t VarByte::size() const{
-  return B.size() * sizeof(B[0]);
-}
-
-int VarByte::save(ofstream& ofs) const{
-  uint32_t size = static_cast<uint32_t>(B.size());
-  if (!ofs.write((char*)(&size), sizeof(size))) return -1;
-  if (size == 0) return 0;
-  if (!ofs.write((char*)(&B[0]), sizeof(B[0]) * B.size())) return -1;
-  return 0;
-}
-
-int VarByte::load(ifstream& ifs){
-  uint32_t size = 0;
-  if (!ifs.read((char*)(&size), sizeof(size))) return -1;
-  if (size == 0) return 0;
-  B.resize(size);
-  if (!ifs.read((char*)(&B[0]), sizeof(B[0]) * B.size())) return -1;
-  return 0;
-}
-
 }
 
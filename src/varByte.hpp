@@ -27,28 +27,26 @@
 #ifndef VAR_BYTE_HPP__
 #define VAR_BYTE_HPP__
 
-#include "compressedBlock.hpp"
+#include <vector>
+#include <cstddef>
+#include <stdint.h>
 
 namespace SE{
 
 /**
  * Variable length Byte Code
  */
-class VarByte : public CompressedBlock {
+class VarByte {
 public:
-  VarByte(); ///< Constructor
-  VarByte(const std::vector<uint32_t>& v);
-  ~VarByte(); ///< Destructor
-
-  void encode(const std::vector<uint32_t>& v);
-  void decode(std::vector<uint32_t>& v);
-  size_t size() const;
-
-  int save(std::ofstream& ofs) const;
-  int load(std::ifstream& ifs);
-
-private:
-  std::vector<uint8_t> B;
+  /**
+   * Append the code of v to out (for blocks in an arena)
+   */
+  static void encode(const std::vector<uint32_t>& v, std::vector<uint8_t>& out);
+
+  /**
+   * Decode n positions from the code p of size bytes
+   */
+  static void decode(const uint8_t* p, const size_t size, uint32_t* v, const size_t n);
 };
 
 }
@@ -0,0 +1,160 @@
+/*
+ * waveletMatrix.cpp
+ * Copyright (c) 2009 Daisuke Okanohara All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cstring>
+#include "waveletMatrix.hpp"
+
+using namespace std;
+
+namespace SE{
+
+WaveletMatrix::WaveletMatrix(){
+  for (int l = 0; l < LEVELN; ++l){
+    zeros[l] = 0;
+  }
+  for (int c = 0; c < 0x100; ++c){
+    starts[c] = 0;
+  }
+}
+
+WaveletMatrix::~WaveletMatrix(){
+}
+
+void WaveletMatrix::build(const vector<uint8_t>& s){
+  vector<uint8_t> cur(s);
+  vector<uint8_t> next(s.size());
+  for (int l = 0; l < LEVELN; ++l){
+    const int shift = LEVELN - 1 - l;
+    levels[l] = BitVector();
+    size_t zeroN = 0;
+    for (size_t i = 0; i < cur.size(); ++i){
+      const bool bit = (cur[i] >> shift) & 1;
+      levels[l].push_back(bit);
+      zeroN += !bit;
+    }
+    levels[l].build();
+    zeros[l] = zeroN;
+
+    // Stable partition: zeros then ones
+    size_t z = 0;
+    size_t o = zeroN;
+    for (size_t i = 0; i < cur.size(); ++i){
+      if ((cur[i] >> shift) & 1){
+	next[o++] = cur[i];
+      } else {
+	next[z++] = cur[i];
+      }
+    }
+    cur.swap(next);
+  }
+  setStarts();
+}
+
+void WaveletMatrix::setStarts(){
+  for (int c = 0; c < 0x100; ++c){
+    size_t beg = 0;
+    for (int l = 0; l < LEVELN; ++l){
+      if ((c >> (LEVELN - 1 - l)) & 1){
+	beg = zeros[l] + levels[l].rank1(beg);
+      } else {
+	beg = levels[l].rank0(beg);
+      }
+    }
+    starts[c] = beg;
+  }
+}
+
+uint8_t WaveletMatrix::access(size_t i) const{
+  uint8_t c = 0;
+  for (int l = 0; l < LEVELN; ++l){
+    const BitVector& bv(levels[l]);
+    if (bv.get(i)){
+      c |= 1 << (LEVELN - 1 - l);
+      i = zeros[l] + bv.rank1(i);
+    } else {
+      i = bv.rank0(i);
+    }
+  }
+  return c;
+}
+
+// Bytes c in [0, i) are mapped to [starts[c], i') in the last level
+
+size_t WaveletMatrix::rank(const uint8_t c, size_t i) const{
+  for (int l = 0; l < LEVELN; ++l){
+    const BitVector& bv(levels[l]);
+    if ((c >> (LEVELN - 1 - l)) & 1){
+      i = zeros[l] + bv.rank1(i);
+    } else {
+      i = bv.rank0(i);
+    }
+  }
+  return i - starts[c];
+}
+
+uint8_t WaveletMatrix::accessRank(size_t i, size_t& r) const{
+  uint8_t c = 0;
+  for (int l = 0; l < LEVELN; ++l){
+    const BitVector& bv(levels[l]);
+    if (bv.get(i)){
+      c |= 1 << (LEVELN - 1 - l);
+      i = zeros[l] + bv.rank1(i);
+    } else {
+      i = bv.rank0(i);
+    }
+  }
+  r = i - starts[c];
+  return c;
+}
+
+size_t WaveletMatrix::getSize() const{
+  size_t ret = sizeof(zeros);
+  for (int l = 0; l < LEVELN; ++l){
+    ret += levels[l].getSize();
+  }
+  return ret;
+}
+
+int WaveletMatrix::save(ofstream& ofs) const{
+  if (!ofs.write((const char*)(zeros), sizeof(zeros))) return -1;
+  for (int l = 0; l < LEVELN; ++l){
+    if (levels[l].save(ofs) == -1) return -1;
+  }
+  return 0;
+}
+
+int WaveletMatrix::load(MappedFile& mf){
+  const uint8_t* p = mf.get(sizeof(zeros), 1);
+  if (p == NULL) return -1;
+  memcpy(zeros, p, sizeof(zeros));
+  for (int l = 0; l < LEVELN; ++l){
+    if (levels[l].load(mf) == -1) return -1;
+  }
+  setStarts();
+  return 0;
+}
+
+}
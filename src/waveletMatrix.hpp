@@ -0,0 +1,101 @@
+/*
+ * waveletMatrix.hpp
+ * Copyright (c) 2009 Daisuke Okanohara All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef WAVELET_MATRIX_HPP__
+#define WAVELET_MATRIX_HPP__
+
+#include <vector>
+#include <fstream>
+#include <stdint.h>
+#include "bitVector.hpp"
+
+namespace SE{
+
+/**
+ * Wavelet matrix over a byte sequence.
+ * access and rank take 8 rank operations on bit vectors.
+ */
+class WaveletMatrix {
+public:
+  WaveletMatrix(); ///< Constructor
+  ~WaveletMatrix(); ///< Destructor
+
+  /**
+   * Build from a byte sequence
+   * @param s A byte sequence
+   */
+  void build(const std::vector<uint8_t>& s);
+
+  /**
+   * @param i A position
+   * @return The i-th byte
+   */
+  uint8_t access(size_t i) const;
+
+  /**
+   * @param c A byte
+   * @param i A position (<= size())
+   * @return The number of c in [0, i)
+   */
+  size_t rank(const uint8_t c, size_t i) const;
+
+  /**
+   * Access and rank at once
+   * @param i A position
+   * @param r The number of the i-th byte in [0, i)
+   * @return The i-th byte
+   */
+  uint8_t accessRank(size_t i, size_t& r) const;
+
+  /**
+   * @return The length of the sequence
+   */
+  size_t size() const {
+    return levels[0].size();
+  }
+
+  /**
+   * @return The number of bytes used
+   */
+  size_t getSize() const;
+
+  int save(std::ofstream& ofs) const;
+  int load(MappedFile& mf);
+
+private:
+  enum {
+    LEVELN = 8
+  };
+  void setStarts();
+
+  BitVector levels[LEVELN]; ///< Bits from the most significant bit
+  uint64_t zeros[LEVELN];   ///< The number of zeros in each level
+  uint64_t starts[0x100];   ///< The first position of each byte in the last level (not saved)
+};
+
+}
+
+#endif // WAVELET_MATRIX_HPP__